@@ -64,10 +64,14 @@ private:
   size_t _current_move_index = 1;
 
   // to keep track of the current board being displayed from
-  // the history in board_manager. after any legal move is
-  // made this should be incremented.
+  // _board_history. after any legal move is made this should
+  // be incremented.
   size_t _current_history_index = 0;
 
+  // every position reached in the current game, used to
+  // step backwards and forwards through the game
+  std::vector<std::array<std::optional<chess::Piece>, 64>> _board_history;
+
   const QUrl _move_sound = QUrl("qrc:/sounds/move.mp3");
   const QUrl _game_end_sound = QUrl("qrc:/sounds/game_end.mp3");
   const QUrl _illegal_sound = QUrl("qrc:/sounds/illegal_move.mp3");
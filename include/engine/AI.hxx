@@ -1,10 +1,20 @@
 #pragma once
 
-#include <unordered_map>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
 
 #include "MoveGenerator.hxx"
 #include "BoardManager.hxx"
 #include "ChessUtil.hxx"
+#include "MovePicker.hxx"
+#include "TranspositionTable.hxx"
 
 namespace chess {
 
@@ -17,7 +27,7 @@ public:
 
   AI(const AI&) = delete;
   AI(AI&&) = delete;
-  ~AI() = default;
+  ~AI();
 
   Color color() { return cfg.controlling; }
 
@@ -31,126 +41,195 @@ public:
 
   int getBlackEval() const { return _black_eval; };
 
-  std::optional<HashedMove> getBestMove(const BoardManager&);
+  // receives the result of a search, called from a search thread
+  using SearchCallback = std::function<void(const SearchResult&)>;
+
+  // search the position for the best move within the provided limits,
+  // all threads search the same position and share what they find
+  // through the transposition table (lazy smp)
+  SearchResult getBestMove(const BoardManager&,
+                           const SearchLimits& limits = {});
+
+  // start searching on the thread pool and return immediately, on_done
+  // is called with the result before the search counts as finished.
+  // on_info is called after every completed iteration, without it the
+  // iterations are logged
+  void startSearch(const BoardManager&,
+                   const SearchLimits& limits,
+                   SearchCallback on_done = {},
+                   SearchCallback on_info = {});
+
+  // block until the current search, if any, has finished
+  SearchResult wait();
+
+  // ask a running search to return as soon as possible,
+  // a search started after this is not affected
+  void stop() { _stop = true; }
+
+  // set the number of threads used by the search
+  void setThreads(size_t n);
+
+  // number of nodes visited by the last search, summed over all threads
+  uint64_t nodes() const;
+
+  // resize the transposition table in MB, this clears it
+  void setHashSize(size_t size_mb) { _tt.resize(size_mb); }
+
+  // forget the results of previous searches, e.g. for a new game
+  void clearHash() { _tt.clear(); }
 
   AIConfig cfg;
 
 private:
   const MoveGenerator* _generator;
 
-  int _depth;
-  int _white_eval;
-  int _black_eval;
-  int _white_material_score;
-  int _black_material_score;
+  // deepest iteration the search will start
+  static constexpr int MaxDepth = 64;
 
-  // calc material diff score
-  std::pair<int,int> calcMaterialScore(const BoardManager& b) const;
+  // deepest ply the search can reach, quiescence included
+  static constexpr int MaxPly = 128;
 
-  int calcPositionalScore(const BoardManager& b, Color c);
+  // per thread search state, padded so counters don't share a cache line
+  struct alignas(64) SearchThread {
+    size_t id = 0;
 
-  int evaluate(MoveResult last_move, const BoardManager& b, int depth);
+    // written by the owning thread only, read by the main thread
+    std::atomic<uint64_t> nodes = 0;
 
-  int miniMax(MoveResult last, BoardManager& mgr, int alpha, int beta, int cur_depth, bool is_max);
+    // the last search this thread took part in
+    uint64_t search_id = 0;
 
-  // get the legal moves from a board
-  std::vector<HashedMove> getLegalMoves(const BoardManager&);
+    // move ordering learned while searching, only touched by this thread
+    std::array<Killers, MaxPly> killers {};
+    HistoryTable history {};
 
-  const std::unordered_map<int, int> piece_values = {
-    { util::toul(Piece::WhitePawn),    100    },
-    { util::toul(Piece::WhiteKnight),  300    },
-    { util::toul(Piece::WhiteBishop),  325    },
-    { util::toul(Piece::WhiteRook),    500    },
-    { util::toul(Piece::WhiteQueen),   900    },
-    { util::toul(Piece::WhiteKing),    10'000 },
+    // triangular principal variation table, the line found from ply
+    // is pv[ply][ply] up to pv_length[ply]
+    std::array<std::array<HashedMove, MaxPly>, MaxPly> pv;
+    std::array<int, MaxPly> pv_length {};
 
-    { util::toul(Piece::BlackPawn),    100    },
-    { util::toul(Piece::BlackKnight),  300    },
-    { util::toul(Piece::BlackBishop),  325    },
-    { util::toul(Piece::BlackRook),    500    },
-    { util::toul(Piece::BlackQueen),   900    },
-    { util::toul(Piece::BlackKing),    10'000 }
-  };
+    // deepest ply reached in the current iteration
+    int seldepth = 0;
 
-  static constexpr std::array<int, 64> pawn_values = {
-     90, 100, 100, 100, 100, 100, 100,  90,
-     40,  40,  50,  60,  60,  50,  40,  40,
-     20,  20,  50,  55,  55,  50,  20,  20,
-     10,  10,  40,  50,  50,  40,  10,  10,
-      0,   0,  20,  40,  40,  20,   0,   0,
-    -10, -10,  10,  30,  30,  10, -10, -10,
-      1,   1,   1,   1,   1,   1,   1,   1,
-      0,   0,   0,   0,   0,   0,   0,   0
+    std::thread thread;
   };
 
-  static constexpr std::array<int, 64> knight_values = {
-   0,   0,   0,   0,   0,   0,   0,  0,
-   0,   5,   5,   5,   5,   5,   5,  0,
-   0,   5,  20,   25, 25,  20,   5,  0,
-   0,   5,  10,   30, 30,  10,   5,  0,
-   0,   5,  10,   30, 30,  10,   5,  0,
-   0,   5,  20,   25, 25,  20,   5,  0,
-   0,   5,   5,   5,   5,   5,   5,  0,
-   0,   0,   0,   0,   0,   0,   0,  0
-  };
+  // thread 0 is the main thread, it owns time keeping and the result
+  std::vector<std::unique_ptr<SearchThread>> _threads;
 
-  static constexpr std::array<int, 64> king_values = {
-   0,   0,   0,   0,   0,   0,   0,  0,
-   0,   0,   0,   0,   0,   0,   0,  0,
-   0,   0,   0,   0,   0,   0,   0,  0,
-   0,   0,   0,   0,   0,   0,   0,  0,
-   0,   0,   0,   0,   0,   0,   0,  0,
-   0,   0,   0,   0,   0,   0,   0,  0,
-   0,   0,   0,   0,   0,   0,   0,  0,
-   0,   0,   0,   0,   0,   0,   0,  0
-  };
+  // the threads live as long as the AI and park here between searches
+  std::mutex _pool_mutex;
+  std::condition_variable _start_cv;
+  std::condition_variable _done_cv;
+  uint64_t _search_id = 0;
+  size_t _searching = 0;
+  bool _quit = false;
 
-  static constexpr std::array<int, 64> bishop_values = {
-   10,   0,   0,   0,   0,   0,   0, 10,
-   10,  10,   0,   0,   0,   0,  10,  0,
-    0,   0,   0,   0,   0,   0,   0,  0,
-    0,   0,   0,   0,   0,   0,   0,  0,
-    0,   0,   0,   0,   0,   0,   0,  0,
-    0,   0,   0,   0,   0,   0,   0,  0,
-    0,  10,   0,   0,   0,   0,  10,  0,
-   10,   0,   0,   0,   0,   0,   0, 10
-  };
+  // handed to the threads by startSearch
+  std::optional<BoardManager> _root;
+  MoveList _root_moves;
+  int _max_depth = 0;
+  std::optional<std::chrono::milliseconds> _soft_limit;
+  std::chrono::steady_clock::time_point _start_time;
+  SearchCallback _on_done;
+  SearchCallback _on_info;
+  SearchResult _result;
 
-  static constexpr std::array<int, 64> rook_values = {
-   0,   10,  10,  10,   10,  10,  10,   0,
-   10,  10,  10,  10,   10,  10,  10,  10,
-    0,   0,   0,   0,    0,   0,   0,   0,
-    0,   0,   0,   0,    0,   0,   0,   0,
-    0,   0,   0,   0,    0,   0,   0,   0,
-    0,   0,   0,   0,    0,   0,   0,   0,
-   10,  10,  10,  10,   10,  10,  10,  10,
-    0,  10,  10,  10,   10,  10,  10,   0
-  };
+  // wait for work until the pool shuts down
+  void idleLoop(SearchThread& t);
 
-  static constexpr std::array<int, 64> queen_values = {
-   0,   0,   0,   0,   0,   0,   0,  0,
-   0,   0,   0,   0,   0,   0,   0,  0,
-   0,   0,   0,   0,   0,   0,   0,  0,
-   0,   0,   0,   0,   0,   0,   0,  0,
-   0,   0,   0,   0,   0,   0,   0,  0,
-   0,   0,   0,   0,   0,   0,   0,  0,
-   0,   0,   0,   0,   0,   0,   0,  0,
-   0,   0,   0,   0,   0,   0,   0,  0
-  };
+  // run by thread 0, searches and then collects the helpers
+  void mainSearch(SearchThread& t);
 
-  std::unordered_map<Piece, std::array<int, 64>> positional_map {
-    {Piece::WhitePawn, pawn_values},
-    {Piece::WhiteKnight, knight_values},
-    {Piece::WhiteBishop, bishop_values},
-    {Piece::WhiteRook, rook_values},
-    {Piece::WhiteQueen, queen_values},
-    {Piece::WhiteKing, king_values},
-    {Piece::BlackPawn, pawn_values},
-    {Piece::BlackKnight, knight_values},
-    {Piece::BlackBishop, bishop_values},
-    {Piece::BlackRook, rook_values},
-    {Piece::BlackQueen, queen_values},
-    {Piece::BlackKing, king_values}
-  };
+  // stop and join every thread
+  void shutdownThreads();
+
+  // results of previous searches, shared by all search threads
+  TranspositionTable _tt;
+
+  // search control, shared by all search threads
+  std::atomic<bool> _stop = false;
+  uint64_t _node_limit = 0;
+  std::optional<std::chrono::steady_clock::time_point> _deadline;
+
+  // has the search been stopped or run out of nodes or time
+  bool shouldStop(SearchThread& t);
+
+  // bigger than any score the search can return
+  static constexpr int Infinity = 1'000'000'000;
+
+  // being mated at the root, a mate n plies away scores n less so the
+  // search prefers the quickest mate and the slowest loss
+  static constexpr int MateScore = 100'000;
+
+  // any score past this is a forced mate
+  static constexpr int MateBound = MateScore - MaxPly;
+
+  // first aspiration window around the previous iteration's score
+  static constexpr int AspirationWindow = 25;
+
+  // plies a late quiet move is reduced by before history is considered
+  static int lmrReduction(int depth, int moves_searched);
+
+  // mate scores are stored relative to the node instead of the root,
+  // so they stay right when the position is reached at another ply
+  static int scoreToTT(int score, int ply);
+  static int scoreFromTT(int score, int ply);
+
+  // time for a search without any limits, e.g. from the gui
+  static constexpr std::chrono::milliseconds DefaultMoveTime { 3000 };
+
+  // kept back from every time budget for communication and cleanup
+  static constexpr std::chrono::milliseconds MoveOverhead { 20 };
+
+  // depth limit for the configured difficulty
+  int maxDepth() const;
+
+  // sets _deadline from the limits and returns the time after which no
+  // new iteration should be started, if any
+  std::optional<std::chrono::milliseconds> allocateTime(const SearchLimits& limits,
+                                                        Color us);
+
+  // deepen until _max_depth or stopped, returns the result of the
+  // last completed iteration
+  SearchResult iterativeDeepening(SearchThread& t);
+
+  // the move raised alpha at ply, it heads the line from ply followed
+  // by the line found below it
+  static void updatePv(SearchThread& t, const HashedMove& move, int ply);
+
+  // search the root moves to depth within the window, the best is
+  // moved to the front. returns its score, or nothing if the search
+  // was stopped
+  std::optional<int> searchRoot(SearchThread& t,
+                                BoardManager& board,
+                                MoveList& root_moves,
+                                int depth, int alpha, int beta);
+
+  int _white_eval;
+  int _black_eval;
+  int _white_material_score;
+  int _black_material_score;
+
+  // scores the position from the side to move's point of view
+  int evaluate(MoveResult last_move, const BoardManager& b, int ply);
+
+  // principal variation search, the first move gets the full window and
+  // the others a null window that is only widened if they beat alpha.
+  // scores are from the side to move's point of view
+  int negaMax(SearchThread& t, BoardManager& mgr,
+              int alpha, int beta, int depth, int ply);
+
+  // a quiet move caused a cutoff, remember it as a killer and move it up
+  // the history at the expense of the quiets searched before it
+  void updateQuietStats(SearchThread& t, Color side, const HashedMove& move,
+                        const MoveList& quiets_tried, int depth, int ply);
+
+  // capture search run at the leaves of negaMax
+  int quiesce(SearchThread& t, BoardManager& mgr,
+              int alpha, int beta, int ply);
+
+  // get the legal moves from a board, most promising first
+  MoveList getLegalMoves(BoardManager&);
 };
 }
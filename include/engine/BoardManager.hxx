@@ -6,7 +6,9 @@
 #include <string>
 
 #include "ChessUtil.hxx"
+#include "Evaluation.hxx"
 #include "MoveGenerator.hxx"
+#include "Zobrist.hxx"
 
 namespace chess {
 
@@ -19,18 +21,57 @@ public:
   BoardManager(BoardManager&&) = delete;
   ~BoardManager() = default;
 
-private:
-  BoardManager(const MoveGenerator* g,
-               const Board&,
-               const BoardState&,
-               const std::vector<HashedMove>&);
+  // maximum number of moves that can be taken back
+  static constexpr size_t MaxHistory = 1024;
 
-public:
   // attempts to perfrom the provided move on the board
   [[nodiscard]] std::tuple<MoveResult, HashedMove> tryMove(const chess::Move& move);
 
+  // performs the move on the board in place, the move must be legal,
+  // e.g. one from generateMoves. does not regenerate the move list
+  void makeMove(const HashedMove& move);
+
+  // takes back the last move made with makeMove
+  void unmakeMove();
+
+  // passes the turn to the other side without moving, the side to
+  // move must not be in check
+  void makeNullMove();
+
+  // takes back the last null move
+  void unmakeNullMove();
+
+  // was the last move made a null move
+  bool lastMoveWasNull() const {
+    return _ply > 0 && _history[_ply - 1].move.hashed == 0;
+  }
+
+  // generate the legal moves of the current position
+  void generateMoves(MoveList& moves) const {
+    _generator->generateMoves(_board, _state, moves);
+  }
+
+  // generate the legal captures and promotions of the current position
+  void generateCaptures(MoveList& moves) const {
+    _generator->generateCaptures(_board, _state, moves);
+  }
+
+  // generate the legal moves that are neither captures nor promotions
+  void generateQuiets(MoveList& moves) const {
+    _generator->generateQuiets(_board, _state, moves);
+  }
+
+  // static exchange evaluation of a move in the current position
+  int see(const HashedMove& move) const {
+    return _generator->see(_board, move);
+  }
+
   // return the squares that the piece can go to, provided a piece is there
-  std::vector<uint8_t> getPseudoLegalMoves(uint8_t square) const;
+  std::vector<uint8_t> getLegalMoves(uint8_t square) const;
+
+  // expand a packed move made in the current position back to the full
+  // move, the result is only meaningful if the move is legal here
+  HashedMove unpack(PackedMove move) const;
 
   // return the move if found in the hashed form
   std::optional<HashedMove> findMove(uint8_t source,
@@ -42,14 +83,24 @@ public:
 
   // get an array represenation of the current board
   std::array<std::optional<Piece>, 64> toArray() const {
-    return chess::to_array(_board);
+    std::array<std::optional<Piece>, 64> ret;
+    for (auto i : util::range(NoSquare)) {
+      ret[i] = pieceAt(i);
+    }
+    return ret;
   }
 
   // returns the piece at the provided square, if applicable
   std::optional<Piece> pieceAt(uint8_t square) const {
-    return chess::piece_at(_board, square);
+    if (_mailbox[square] == NoPiece) {
+      return std::nullopt;
+    }
+    return _mailbox[square];
   }
 
+  // returns the piece at the provided square, NoPiece if empty
+  Piece pieceOn(uint8_t square) const { return _mailbox[square]; }
+
   // get the color of the current side to move
   Color getSideToMove() const { return _state.side_to_move; }
 
@@ -59,13 +110,30 @@ public:
   // get the current full move count
   uint8_t getFullMoveCount() const { return _state.full_move_count; }
 
-  // return the fen string at the provided index
-  std::optional<std::string> historyAt(size_t index) {
-    if (index < _history.size()) {
-      return _history[index];
-    }
-    return std::nullopt;
-  }
+  // sum of the piece values of color
+  int material(Color c) const { return _material[c]; }
+
+  // sum of the piece square bonuses of color
+  eval::Score positional(Color c) const { return _positional[c]; }
+
+  // non-pawn material left for both sides, see eval::MaxPhase
+  int phase() const { return _phase; }
+
+  // get the zobrist key of the current position
+  zobrist::Key getHash() const { return _hash; }
+
+  // get the number of moves made since the board was last reset
+  size_t historySize() const { return _ply; }
+
+  // is the side to move in check
+  bool inCheck() const { return isCheck(_board, _state); }
+
+  // has the current position occurred count times before, a search
+  // treats the first repetition as a draw, a game the second
+  bool isRepetition(int count = 1) const;
+
+  // have both sides made fifty moves without a capture or pawn move
+  bool isFiftyMoveDraw() const { return _state.half_move_clock >= 100; }
 
   // reset the board back to the starting position
   void reset() {
@@ -82,6 +150,15 @@ public:
     return fen::generate(_board, _state);
   }
 
+  // does color have anything besides pawns and the king, without it
+  // zugzwang is common
+  bool hasNonPawnMaterial(Color c) const {
+    const Bitboard pawns_and_king = (c == White)
+      ? _board[WhitePawn] | _board[WhiteKing]
+      : _board[BlackPawn] | _board[BlackKing];
+    return _board[c == White ? WhiteAll : BlackAll] & ~pawns_and_king;
+  }
+
   // get the current number of the provided piece on the board
   auto pieceCount(Piece piece = Piece::All) const {
     return bits::count(_board[piece]);
@@ -96,28 +173,74 @@ private:
   // collection of all Bitboards, layout is the same as the chess::Piece enum
   Board _board;
 
+  // the piece on each square, kept in sync with _board
+  std::array<Piece, 64> _mailbox;
+
+  // evaluation totals per color, kept in sync with the mailbox
+  std::array<int, 2> _material {};
+  std::array<eval::Score, 2> _positional {};
+  int _phase = 0;
+
   // flags for the game state
   BoardState _state;
 
+  // zobrist key of the current position, updated incrementally
+  zobrist::Key _hash = 0ULL;
+
+  // one entry per move made, holds what is needed to
+  // take the move back and the key of the position before it.
+  // null moves leave the move empty
+  struct Undo {
+    HashedMove move;
+    uint8_t castling_rights;
+    uint8_t en_passant_target;
+    uint8_t half_move_clock;
+    zobrist::Key key;
+  };
+
   // move generator
   const MoveGenerator* _generator;
 
-  // current list of pseudo legal moves
-  std::vector<HashedMove> _move_list;
+  // current list of legal moves
+  MoveList _move_list;
 
-  // FEN history of the current game being played
-  std::vector<std::string> _history;
+  // key and undo history of the current game being played
+  std::array<Undo, MaxHistory> _history;
 
-  // flag to not generate fen history
-  // useful for AI move making when in move search
-  bool NO_HISTORY = false;
-
-  // performs the move on the board
-  MoveResult makeMove(const HashedMove& move);
+  // number of entries in use in _history
+  size_t _ply = 0;
 
   // initialize board from FEN string
   void initFromFen(const std::string& fen);
 
+  // rebuild the mailbox and evaluation totals from the bitboards
+  void initMailbox();
+
+  // place, remove and move a piece on the bitboards, mailbox and
+  // evaluation totals, occupancies are left to updateOccupancies
+  void putPiece(Piece p, uint8_t square) {
+    set_bit(square, _board[p]);
+    _mailbox[square] = p;
+    _material[eval::color_of(p)] += eval::piece_values[p];
+    _positional[eval::color_of(p)] += eval::psq[p][square];
+    _phase += eval::phase_values[p];
+  }
+
+  void removePiece(Piece p, uint8_t square) {
+    clear_bit(square, _board[p]);
+    _mailbox[square] = NoPiece;
+    _material[eval::color_of(p)] -= eval::piece_values[p];
+    _positional[eval::color_of(p)] -= eval::psq[p][square];
+    _phase -= eval::phase_values[p];
+  }
+
+  void movePiece(Piece p, uint8_t from, uint8_t to) {
+    move_bit(from, to, _board[p]);
+    _mailbox[from] = NoPiece;
+    _mailbox[to] = p;
+    _positional[eval::color_of(p)] += eval::psq[p][to] - eval::psq[p][from];
+  }
+
   // is the board in check
   bool isCheck(const Board&, const BoardState&) const;
 
@@ -2,6 +2,10 @@
 
 #include <tuple>
 #include <array>
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include <vector>
 
 #include "Constants.hxx"
 
@@ -48,7 +52,8 @@ namespace chess {
       uint32_t double_push : 1;
       uint32_t enpassant : 1;
       uint32_t castling : 1;
-      uint32_t : 6;
+      uint32_t captured : 5; // the piece taken, NoPiece if not a capture
+      uint32_t : 1;
     } m;
 
     uint32_t hashed;
@@ -70,6 +75,103 @@ namespace chess {
                static_cast<uint8_t>(m.target),
                static_cast<chess::Piece>(m.promoted) };
     }
+
+    Piece captured() const { return static_cast<Piece>(m.captured); }
+  };
+
+  // 16 bit form of a move for tables that store many of them, only the
+  // squares and what kind of move it is are kept. the rest comes back
+  // from the position the move is played in, see BoardManager::unpack
+  class PackedMove {
+  public:
+    enum Kind : uint16_t {
+      Normal,
+      Promotion,
+      EnPassant,
+      Castling
+    };
+
+    constexpr PackedMove() = default;
+
+    constexpr PackedMove(uint8_t source, uint8_t target,
+                         Kind kind = Normal, Piece promoted = NoPiece)
+      : _data(source | (target << 6) | (kind << 14) |
+              (kind == Promotion ? promotionIndex(promoted) << 12 : 0))
+    {}
+
+    constexpr explicit PackedMove(const HashedMove& move)
+      : PackedMove(move.m.source, move.m.target,
+                   move.m.promoted  ? Promotion :
+                   move.m.enpassant ? EnPassant :
+                   move.m.castling  ? Castling  : Normal,
+                   static_cast<Piece>(move.m.promoted))
+    {}
+
+    constexpr uint8_t source() const { return _data & 0x3F; }
+    constexpr uint8_t target() const { return (_data >> 6) & 0x3F; }
+    constexpr Kind kind() const { return static_cast<Kind>(_data >> 14); }
+
+    // promoted piece for the side moving, NoPiece if not a promotion
+    constexpr Piece promoted(Color side) const {
+      if (kind() != Promotion) {
+        return NoPiece;
+      }
+      int piece = WhiteKnight + ((_data >> 12) & 0x3);
+      return static_cast<Piece>(side == White ? piece : piece + BlackPawn - WhitePawn);
+    }
+
+    // the null move, nothing real packs to 0 since source == target
+    constexpr bool empty() const { return _data == 0; }
+
+    constexpr uint16_t raw() const { return _data; }
+
+    static constexpr PackedMove fromRaw(uint16_t raw) {
+      PackedMove m;
+      m._data = raw;
+      return m;
+    }
+
+    constexpr bool operator==(const PackedMove&) const = default;
+
+  private:
+    // knight, bishop, rook, queen as 0 - 3 for either color
+    static constexpr uint16_t promotionIndex(Piece p) {
+      return (p < BlackPawn ? p - WhiteKnight : p - BlackKnight) & 0x3;
+    }
+
+    uint16_t _data = 0;
+  };
+
+  static_assert(sizeof(PackedMove) == 2);
+
+  // fixed capacity list of moves, lives entirely on the stack
+  // 256 is above the maximum number of moves in any legal position
+  class MoveList {
+  public:
+    using iterator = HashedMove*;
+    using const_iterator = const HashedMove*;
+
+    static constexpr size_t Capacity = 256;
+
+    void push_back(const HashedMove& m) { _moves[_count++] = m; }
+
+    void clear() { _count = 0; }
+
+    size_t size() const { return _count; }
+
+    bool empty() const { return _count == 0; }
+
+    HashedMove& operator[](size_t i) { return _moves[i]; }
+    const HashedMove& operator[](size_t i) const { return _moves[i]; }
+
+    iterator begin() { return _moves.data(); }
+    iterator end() { return _moves.data() + _count; }
+    const_iterator begin() const { return _moves.data(); }
+    const_iterator end() const { return _moves.data() + _count; }
+
+  private:
+    std::array<HashedMove, Capacity> _moves;
+    size_t _count = 0;
   };
 
   enum class CastlingRights : uint8_t {
@@ -95,10 +197,93 @@ namespace chess {
     Hard
   };
 
+  // forward pruning done by the search, each kind can be switched off
+  struct SearchConfig {
+    // give the opponent a free move, if the position still fails high
+    // the real moves would too
+    bool null_move = true;
+
+    // depth taken off the null move search on top of the skipped move
+    int null_move_reduction = 3;
+
+    // search late quiet moves shallower, and again at full depth
+    // only if they beat alpha
+    bool late_move_reductions = true;
+
+    // moves searched at full depth before any are reduced
+    int lmr_full_depth_moves = 3;
+
+    // remaining depth below which nothing is reduced
+    int lmr_min_depth = 3;
+
+    // near the leaves, stop searching when the static evaluation is
+    // too far above beta, and skip quiets when it is too far below alpha
+    bool futility = true;
+
+    // centipawns per ply of remaining depth
+    int futility_margin = 100;
+
+    // deepest remaining depth futility pruning applies to
+    int futility_depth = 3;
+  };
+
   struct AIConfig {
     AIDifficulty difficulty;
     Color controlling;
     bool assisting_user;
     bool enabled;
+    SearchConfig search = {};
+  };
+
+  // limits for a single search, zero means no limit
+  struct SearchLimits {
+    // maximum depth in plies, zero uses the difficulty's depth
+    int depth = 0;
+
+    // maximum number of nodes to visit
+    uint64_t nodes = 0;
+
+    // fixed time to search for in milliseconds
+    int64_t move_time = 0;
+
+    // remaining clock time and increment in milliseconds, indexed by Color
+    std::array<int64_t, 2> time = { 0, 0 };
+    std::array<int64_t, 2> increment = { 0, 0 };
+
+    // moves until the next time control, zero for sudden death
+    int moves_to_go = 0;
+
+    // search until stopped
+    bool infinite = false;
+  };
+
+  // what a search found, as of its last completed iteration
+  struct SearchResult {
+    // the expected line of play, starting with the best move
+    std::vector<HashedMove> pv;
+
+    // nominal depth of the iteration and the deepest ply reached in it
+    int depth = 0;
+    int seldepth = 0;
+
+    // nodes visited by all threads
+    uint64_t nodes = 0;
+
+    // centipawns from the side to move's point of view
+    int score = 0;
+
+    // moves until mate, negative when being mated, zero if no mate was found
+    int mate = 0;
+
+    // time since the search started
+    std::chrono::milliseconds time {};
+
+    // the move to play, nothing when there are no legal moves
+    std::optional<HashedMove> bestMove() const {
+      if (pv.empty()) {
+        return std::nullopt;
+      }
+      return pv.front();
+    }
   };
 }
@@ -23,6 +23,9 @@ namespace chess {
   // like Checkmate, Stalemate, or Draws
   std::string to_string(const HashedMove& m);
 
+  // convert a HashedMove into coordinate notation, e.g. e2e4 or e7e8q
+  std::string to_uci_string(const HashedMove& m);
+
   // convert the Bitboard to a string
   std::string to_string(const Bitboard& m);
 
@@ -0,0 +1,225 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+
+#include "ChessTypes.hxx"
+
+// static evaluation terms, kept up to date by BoardManager as pieces
+// move so scoring a position needs no scan of the board
+namespace chess::eval {
+
+  // a middlegame and an endgame value, blended by the game phase
+  struct Score {
+    int mg = 0;
+    int eg = 0;
+
+    constexpr Score& operator+=(Score o) { mg += o.mg; eg += o.eg; return *this; }
+    constexpr Score& operator-=(Score o) { mg -= o.mg; eg -= o.eg; return *this; }
+
+    constexpr Score operator+(Score o) const { return { mg + o.mg, eg + o.eg }; }
+    constexpr Score operator-(Score o) const { return { mg - o.mg, eg - o.eg }; }
+
+    constexpr bool operator==(const Score&) const = default;
+  };
+
+  // indexed by Piece, kings are worth more than everything else together
+  inline constexpr std::array<int, 16> piece_values = {
+    0,
+    100, 300, 325, 500, 900, 10'000,
+    100, 300, 325, 500, 900, 10'000,
+    0, 0, 0
+  };
+
+  // the phase is the non-pawn material left on the board, it starts at
+  // MaxPhase and goes to 0 as pieces are traded
+  inline constexpr int MaxPhase = 24;
+
+  // indexed by Piece
+  inline constexpr std::array<int, 16> phase_values = {
+    0,
+    0, 1, 1, 2, 4, 0,
+    0, 1, 1, 2, 4, 0,
+    0, 0, 0
+  };
+
+  namespace detail {
+    // drawn as seen from white, rank 8 at the top
+    inline constexpr std::array<int, 64> pawn_mg = {
+       90, 100, 100, 100, 100, 100, 100,  90,
+       40,  40,  50,  60,  60,  50,  40,  40,
+       20,  20,  50,  55,  55,  50,  20,  20,
+       10,  10,  40,  50,  50,  40,  10,  10,
+        0,   0,  20,  40,  40,  20,   0,   0,
+      -10, -10,  10,  30,  30,  10, -10, -10,
+        1,   1,   1,   1,   1,   1,   1,   1,
+        0,   0,   0,   0,   0,   0,   0,   0
+    };
+
+    // passers decide endgames, every step forward counts
+    inline constexpr std::array<int, 64> pawn_eg = {
+        0,   0,   0,   0,   0,   0,   0,   0,
+      120, 120, 120, 120, 120, 120, 120, 120,
+       80,  80,  80,  80,  80,  80,  80,  80,
+       50,  50,  50,  50,  50,  50,  50,  50,
+       30,  30,  30,  30,  30,  30,  30,  30,
+       15,  15,  15,  15,  15,  15,  15,  15,
+        5,   5,   5,   5,   5,   5,   5,   5,
+        0,   0,   0,   0,   0,   0,   0,   0
+    };
+
+    inline constexpr std::array<int, 64> knight_mg = {
+     0,   0,   0,   0,   0,   0,   0,  0,
+     0,   5,   5,   5,   5,   5,   5,  0,
+     0,   5,  20,   25, 25,  20,   5,  0,
+     0,   5,  10,   30, 30,  10,   5,  0,
+     0,   5,  10,   30, 30,  10,   5,  0,
+     0,   5,  20,   25, 25,  20,   5,  0,
+     0,   5,   5,   5,   5,   5,   5,  0,
+     0,   0,   0,   0,   0,   0,   0,  0
+    };
+
+    inline constexpr std::array<int, 64> knight_eg = {
+    -30, -20, -10, -10, -10, -10, -20, -30,
+    -20,  -5,   0,   5,   5,   0,  -5, -20,
+    -10,   0,  10,  15,  15,  10,   0, -10,
+    -10,   5,  15,  20,  20,  15,   5, -10,
+    -10,   5,  15,  20,  20,  15,   5, -10,
+    -10,   0,  10,  15,  15,  10,   0, -10,
+    -20,  -5,   0,   5,   5,   0,  -5, -20,
+    -30, -20, -10, -10, -10, -10, -20, -30
+    };
+
+    inline constexpr std::array<int, 64> bishop_mg = {
+     10,   0,   0,   0,   0,   0,   0, 10,
+     10,  10,   0,   0,   0,   0,  10,  0,
+      0,   0,   0,   0,   0,   0,   0,  0,
+      0,   0,   0,   0,   0,   0,   0,  0,
+      0,   0,   0,   0,   0,   0,   0,  0,
+      0,   0,   0,   0,   0,   0,   0,  0,
+      0,  10,   0,   0,   0,   0,  10,  0,
+     10,   0,   0,   0,   0,   0,   0, 10
+    };
+
+    inline constexpr std::array<int, 64> bishop_eg = {
+    -15, -10,  -5,  -5,  -5,  -5, -10, -15,
+    -10,   0,   0,   0,   0,   0,   0, -10,
+     -5,   0,   5,   5,   5,   5,   0,  -5,
+     -5,   0,   5,  10,  10,   5,   0,  -5,
+     -5,   0,   5,  10,  10,   5,   0,  -5,
+     -5,   0,   5,   5,   5,   5,   0,  -5,
+    -10,   0,   0,   0,   0,   0,   0, -10,
+    -15, -10,  -5,  -5,  -5,  -5, -10, -15
+    };
+
+    inline constexpr std::array<int, 64> rook_mg = {
+     0,   10,  10,  10,   10,  10,  10,   0,
+     10,  10,  10,  10,   10,  10,  10,  10,
+      0,   0,   0,   0,    0,   0,   0,   0,
+      0,   0,   0,   0,    0,   0,   0,   0,
+      0,   0,   0,   0,    0,   0,   0,   0,
+      0,   0,   0,   0,    0,   0,   0,   0,
+     10,  10,  10,  10,   10,  10,  10,  10,
+      0,  10,  10,  10,   10,  10,  10,   0
+    };
+
+    inline constexpr std::array<int, 64> rook_eg = {
+      5,   5,   5,   5,   5,   5,   5,   5,
+     15,  15,  15,  15,  15,  15,  15,  15,
+      0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0
+    };
+
+    // early queen sorties into the corners and edges are rarely good
+    inline constexpr std::array<int, 64> queen_mg = {
+    -10,  -5,  -5,  -5,  -5,  -5,  -5, -10,
+     -5,   0,   0,   0,   0,   0,   0,  -5,
+     -5,   0,   5,   5,   5,   5,   0,  -5,
+     -5,   0,   5,   5,   5,   5,   0,  -5,
+     -5,   0,   5,   5,   5,   5,   0,  -5,
+     -5,   0,   5,   5,   5,   5,   0,  -5,
+     -5,   0,   0,   0,   0,   0,   0,  -5,
+    -10,  -5,  -5,   0,  -5,  -5,  -5, -10
+    };
+
+    inline constexpr std::array<int, 64> queen_eg = {
+    -20, -10, -10,  -5,  -5, -10, -10, -20,
+    -10,   0,   5,   5,   5,   5,   0, -10,
+    -10,   5,  10,  10,  10,  10,   5, -10,
+     -5,   5,  10,  20,  20,  10,   5,  -5,
+     -5,   5,  10,  20,  20,  10,   5,  -5,
+    -10,   5,  10,  10,  10,  10,   5, -10,
+    -10,   0,   5,   5,   5,   5,   0, -10,
+    -20, -10, -10,  -5,  -5, -10, -10, -20
+    };
+
+    // tucked away behind the pawns while there is material to attack it
+    inline constexpr std::array<int, 64> king_mg = {
+    -40, -40, -40, -50, -50, -40, -40, -40,
+    -40, -40, -40, -50, -50, -40, -40, -40,
+    -40, -40, -40, -50, -50, -40, -40, -40,
+    -40, -40, -40, -50, -50, -40, -40, -40,
+    -30, -30, -30, -40, -40, -30, -30, -30,
+    -20, -20, -20, -20, -20, -20, -20, -20,
+     10,  10,   0, -10, -10,   0,  10,  10,
+     20,  30,  10,   0,   0,  10,  30,  20
+    };
+
+    // and in the middle of things once the queens are gone
+    inline constexpr std::array<int, 64> king_eg = {
+    -40, -30, -20, -20, -20, -20, -30, -40,
+    -30, -10,   0,   0,   0,   0, -10, -30,
+    -20,   0,  15,  20,  20,  15,   0, -20,
+    -20,   0,  20,  30,  30,  20,   0, -20,
+    -20,   0,  20,  30,  30,  20,   0, -20,
+    -20,   0,  15,  20,  20,  15,   0, -20,
+    -30, -10,   0,   0,   0,   0, -10, -30,
+    -40, -30, -20, -20, -20, -20, -30, -40
+    };
+
+    // the tables for each piece as drawn above
+    inline constexpr std::array<const std::array<int, 64>*, 6> mg_tables = {
+      &pawn_mg, &knight_mg, &bishop_mg, &rook_mg, &queen_mg, &king_mg
+    };
+
+    inline constexpr std::array<const std::array<int, 64>*, 6> eg_tables = {
+      &pawn_eg, &knight_eg, &bishop_eg, &rook_eg, &queen_eg, &king_eg
+    };
+
+    constexpr std::array<std::array<Score, 64>, 16> init_psq() {
+      std::array<std::array<Score, 64>, 16> result {};
+
+      for (int i = 0; i < 6; i++) {
+        for (int square = 0; square < 64; square++) {
+          // the top left of a drawing is a8, so white flips the rank
+          // to look up a square. black sees the board from the other
+          // side, which undoes the flip
+          result[WhitePawn + i][square] = { (*mg_tables[i])[square ^ 56],
+                                            (*eg_tables[i])[square ^ 56] };
+          result[BlackPawn + i][square] = { (*mg_tables[i])[square],
+                                            (*eg_tables[i])[square] };
+        }
+      }
+
+      return result;
+    }
+  } // namespace detail
+
+  // positional bonus indexed by [Piece][square]
+  inline constexpr std::array<std::array<Score, 64>, 16> psq = detail::init_psq();
+
+  constexpr Color color_of(Piece p) {
+    return p < BlackPawn ? White : Black;
+  }
+
+  // blend the two values of s by how much material is left, promotions
+  // can take the phase past MaxPhase so it is capped
+  constexpr int taper(Score s, int phase) {
+    phase = std::min(phase, MaxPhase);
+    return (s.mg * phase + s.eg * (MaxPhase - phase)) / MaxPhase;
+  }
+} // namespace chess::eval
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <functional>
+#include <string>
+
+namespace chess::log {
+
+  // receives every message logged by the engine
+  using Sink = std::function<void(const std::string&)>;
+
+  // replace the sink messages are sent to, defaults to std::cerr
+  // passing an empty Sink silences the engine
+  void set_sink(Sink sink);
+
+  // send a message to the current sink, safe to call from any thread
+  void write(const std::string& message);
+
+} // namespace chess::log
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <array>
+#include <cstdlib>
+#include <optional>
+
+#include "BoardManager.hxx"
+
+namespace chess {
+
+// how often quiet moves caused a cutoff, indexed by [side][source][target]
+using HistoryTable = std::array<std::array<std::array<int, 64>, 64>, 2>;
+
+// the last two quiet moves that caused a cutoff at a ply
+using Killers = std::array<PackedMove, 2>;
+
+// history scores stay within +-MaxHistoryScore
+inline constexpr int MaxHistoryScore = 16'384;
+
+// reward or punish a quiet move, entries near the limit move less so
+// recent results keep counting
+inline void update_history(HistoryTable& history, Color side,
+                           const HashedMove& move, int bonus)
+{
+  int& entry = history[side][move.m.source][move.m.target];
+  entry += bonus - entry * std::abs(bonus) / MaxHistoryScore;
+}
+
+// hands out the legal moves of a position one at a time, best guesses
+// first. each stage is only generated once the ones before it are used
+// up, so a cutoff by the hash move or a capture never pays for the quiets
+class MovePicker
+{
+public:
+  // every legal move: the hash move, captures that don't lose material,
+  // killers, the remaining quiets by history, then the losing captures
+  MovePicker(const BoardManager& board,
+             PackedMove tt_move,
+             const Killers& killers,
+             const HistoryTable& history);
+
+  // only the captures and promotions that don't lose material
+  explicit MovePicker(const BoardManager& board);
+
+  // the next move to search, nothing once all have been handed out
+  std::optional<HashedMove> next();
+
+private:
+  enum class Stage {
+    TTMove,
+    GenerateCaptures,
+    GoodCaptures,
+    Killers,
+    Quiets,
+    BadCaptures,
+    Done
+  };
+
+  const BoardManager& _board;
+  const HistoryTable* _history = nullptr;
+
+  PackedMove _tt_move;
+  Killers _killers {};
+
+  Stage _stage;
+
+  // quiescence pickers stop after the good captures
+  bool _captures_only = false;
+
+  // a stage may have been generated early to check the hash move
+  bool _captures_generated = false;
+  bool _quiets_generated = false;
+
+  MoveList _captures;
+  MoveList _quiets;
+  MoveList _bad_captures;
+  std::array<int, MoveList::Capacity> _capture_scores;
+  std::array<int, MoveList::Capacity> _quiet_scores;
+
+  // next unsearched entry of the current list
+  size_t _index = 0;
+  size_t _killer_index = 0;
+
+  void generateCaptures();
+  void generateQuiets();
+
+  // is the move already handed out by an earlier stage
+  bool isSpecial(const HashedMove& move) const;
+
+  // swap the highest scoring move at or after _index into place
+  // and hand it out
+  HashedMove pickBest(MoveList& moves, std::array<int, MoveList::Capacity>& scores);
+};
+} // namespace chess
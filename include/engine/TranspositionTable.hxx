@@ -0,0 +1,99 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "ChessTypes.hxx"
+#include "Util.hxx"
+#include "Zobrist.hxx"
+
+namespace chess {
+
+// how a stored score relates to the true score of the position
+enum class Bound : uint8_t {
+  None,
+  Exact,
+  Lower, // failed high, the score is at least this
+  Upper  // failed low, the score is at most this
+};
+
+// fixed size hash table of search results shared by every search thread
+//
+// entries are 16 bytes, the key is stored xor'd with the data so a torn
+// write from another thread shows up as a key mismatch instead of a bad hit
+class TranspositionTable
+{
+public:
+  static constexpr size_t DefaultSizeMB = 16;
+
+  // what a probe hands back, scores are from the side to move's view
+  struct Entry {
+    PackedMove move;
+    int score;
+    int depth;
+    Bound bound;
+  };
+
+  explicit TranspositionTable(size_t size_mb = DefaultSizeMB);
+
+  TranspositionTable(const TranspositionTable&) = delete;
+  TranspositionTable& operator=(const TranspositionTable&) = delete;
+
+  // reallocate to the largest power of two buckets fitting in size_mb,
+  // all entries are lost
+  void resize(size_t size_mb);
+
+  void clear();
+
+  // called once per search, older entries become preferred for replacement
+  void newSearch() { _generation = (_generation + 1) & GenerationMask; }
+
+  std::optional<Entry> probe(zobrist::Key key) const;
+
+  void store(zobrist::Key key, PackedMove move, int score, int depth, Bound bound);
+
+  // start pulling the bucket for key into cache ahead of the probe
+  void prefetch(zobrist::Key key) const {
+    __builtin_prefetch(&_buckets[key & _mask]);
+  }
+
+private:
+  static constexpr size_t BucketSize = 4;
+  static constexpr uint8_t GenerationMask = 0xF;
+
+  // scores are stored in 24 bits
+  static constexpr int MaxScore = (1 << 23) - 1;
+
+  union Data {
+    struct {
+      uint64_t move : 16;
+      int64_t score : 24;
+      uint64_t depth : 8;
+      uint64_t bound : 2;
+      uint64_t generation : 4;
+    } f;
+
+    uint64_t raw;
+  };
+
+  struct Slot {
+    std::atomic<uint64_t> key_xor_data { 0 };
+    std::atomic<uint64_t> data { 0 };
+  };
+
+  // one cache line
+  struct alignas(64) Bucket {
+    std::array<Slot, BucketSize> slots;
+  };
+
+  static_assert(sizeof(Slot) == 16);
+  static_assert(sizeof(Bucket) == 64);
+
+  std::vector<Bucket> _buckets;
+  uint64_t _mask = 0;
+  uint8_t _generation = 0;
+};
+} // namespace chess
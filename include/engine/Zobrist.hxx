@@ -0,0 +1,103 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "ChessTypes.hxx"
+#include "ChessUtil.hxx"
+
+namespace chess::zobrist {
+
+  using Key = uint64_t;
+
+  namespace detail {
+    // splitmix64, used to fill the key tables at compile time
+    constexpr Key next(Key& seed) {
+      Key z = (seed += 0x9e3779b97f4a7c15ULL);
+      z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+      z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+      return z ^ (z >> 31);
+    }
+
+    struct Keys {
+      // indexed by [Piece][square], NoPiece row is left empty
+      std::array<std::array<Key, 64>, 13> pieces {};
+
+      // indexed by the 4 castling rights bits
+      std::array<Key, 16> castling {};
+
+      // indexed by the file of the en passant target
+      std::array<Key, 8> en_passant {};
+
+      Key side {};
+    };
+
+    constexpr Keys init() {
+      Keys k;
+      Key seed = 0x5375'6b6c'6573'7332ULL;
+
+      for (auto p : AllPieces) {
+        for (auto& sq : k.pieces[p]) {
+          sq = next(seed);
+        }
+      }
+
+      for (auto& c : k.castling) {
+        c = next(seed);
+      }
+
+      for (auto& f : k.en_passant) {
+        f = next(seed);
+      }
+
+      k.side = next(seed);
+      return k;
+    }
+  } // namespace detail
+
+  inline constexpr detail::Keys keys = detail::init();
+
+  // key for the provided piece standing on square
+  constexpr Key piece(Piece p, uint8_t square) {
+    return keys.pieces[p][square];
+  }
+
+  // key for the provided castling rights
+  constexpr Key castling(uint8_t rights) {
+    return keys.castling[rights & 0xF];
+  }
+
+  // key for the provided en passant target, NoSquare hashes to 0
+  constexpr Key en_passant(uint8_t square) {
+    return square == NoSquare ? 0ULL : keys.en_passant[square % 8];
+  }
+
+  // key toggled whenever black is to move
+  constexpr Key side() {
+    return keys.side;
+  }
+
+  // compute the key of a position from scratch
+  constexpr Key hash(const Board& b, const BoardState& s) {
+    Key key = 0ULL;
+
+    for (auto p : AllPieces) {
+      Bitboard pieces = b[p];
+      while (pieces) {
+        uint8_t square = bits::get_lsb_index(pieces);
+        key ^= piece(p, square);
+        pieces &= pieces - 1;
+      }
+    }
+
+    key ^= castling(s.castling_rights);
+    key ^= en_passant(s.en_passant_target);
+
+    if (s.side_to_move == Black) {
+      key ^= side();
+    }
+
+    return key;
+  }
+
+} // namespace chess::zobrist
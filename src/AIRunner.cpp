@@ -31,7 +31,7 @@ AIRunner::AIRunner(QObject* parent)
         _ai.cfg = settings;
 
         if (_ai.enabled() && _manager.getSideToMove() == _ai.color()) {
-          if (auto m = _ai.getBestMove(_manager)) {
+          if (auto m = _ai.getBestMove(_manager).bestMove()) {
             emit moveReady(*m, _ai.color());
           }
         }
@@ -55,7 +55,7 @@ AIRunner::AIRunner(QObject* parent)
 
           qDebug() << "AIRunner: finding best move...\n";
 
-          if (auto move = _ai.getBestMove(_manager)) {
+          if (auto move = _ai.getBestMove(_manager).bestMove()) {
             emit moveReady(*move, _ai.color());
           }
 
@@ -63,7 +63,7 @@ AIRunner::AIRunner(QObject* parent)
         else if (_ai.assisting()) {
           qDebug() << "AIRunner: finding suggestion...\n";
 
-          if (auto move = _ai.getBestMove(_manager)) {
+          if (auto move = _ai.getBestMove(_manager).bestMove()) {
             emit suggestionReady(*move);
           }
         }
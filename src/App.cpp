@@ -1,5 +1,9 @@
 #include "App.h"
 
+#include <QDebug>
+
+#include "engine/Log.hxx"
+
 /******************************************************************************
  *
  * Method: App()
@@ -21,6 +25,11 @@ App::App(int argc, char* argv[])
 
   connect(_engine, &QQmlEngine::quit, this, &App::quit);
 
+  // route engine logging through Qt
+  chess::log::set_sink([](const std::string& message) {
+    qDebug() << message.c_str();
+  });
+
   // setup communication between the game and the ai thread
   connect(&_game, &Game::moveConfirmed, &_ai_thread, &AIRunner::onMoveConfirmed);
   connect(&_game, &Game::gameStart, &_ai_thread, &AIRunner::onGameStart);
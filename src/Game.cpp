@@ -47,6 +47,8 @@ void Game::reset()
   _move_model.clear();
   _current_move_index = 1;
   _current_history_index = 0;
+  _board_history.clear();
+  _board_history.push_back(_board_manager->toArray());
 
   emit gameStart({ chess::AIDifficulty::Easy, chess::Black, false, false },
                    chess::starting_position);
@@ -100,6 +102,7 @@ void Game::handleMove(int from, int to, int promoted_piece)
 
   if (result != chess::MoveResult::Illegal) {
     emit moveConfirmed( move_made, color_moved, result);
+    _board_history.push_back(_board_manager->toArray());
     _current_history_index++;
 
     // end of game conditions
@@ -119,7 +122,9 @@ void Game::handleMove(int from, int to, int promoted_piece)
 
       case chess::MoveResult::Draw:
       {
-        emit gameOver(QString(tr("Draw by Repetition!")));
+        emit gameOver(_board_manager->isFiftyMoveDraw()
+                        ? QString(tr("Draw by the Fifty Move Rule!"))
+                        : QString(tr("Draw by Repetition!")));
         break;
       }
 
@@ -148,6 +153,7 @@ void Game::onMoveReady(chess::HashedMove m, chess::Color color_moved)
 
   if (result != chess::MoveResult::Illegal) {
     emit moveConfirmed( move_made, color_moved, result);
+    _board_history.push_back(_board_manager->toArray());
     _current_history_index++;
 
     // end of game conditions
@@ -167,7 +173,9 @@ void Game::onMoveReady(chess::HashedMove m, chess::Color color_moved)
 
       case chess::MoveResult::Draw:
       {
-        emit gameOver(QString(tr("Draw by Repetition!")));
+        emit gameOver(_board_manager->isFiftyMoveDraw()
+                        ? QString(tr("Draw by the Fifty Move Rule!"))
+                        : QString(tr("Draw by Repetition!")));
         break;
       }
 
@@ -233,16 +241,14 @@ void Game::showPrevious() {
   if (_current_history_index >= 1) {
     --_current_history_index;
 
-    if (auto fen = _board_manager->historyAt(_current_history_index)) {
+    if (_current_history_index < _board_history.size()) {
 
       if (_current_move_index >= 1 && _current_history_index % 2 == 0) {
         _move_model.setSelected(--_current_move_index);
       }
 
-      auto opt = _board_manager->makeBoardFromFen(*fen);
-      auto&& [board, state] = *opt;
-
-      _board_model.setBoard(chess::to_array(board));
+      auto board = _board_history[_current_history_index];
+      _board_model.setBoard(std::move(board));
     }
   }
 }
@@ -254,7 +260,7 @@ void Game::showPrevious() {
  *****************************************************************************/
 void Game::showNext() {
 
-  if (auto fen = _board_manager->historyAt(_current_history_index + 1)) {
+  if (_current_history_index + 1 < _board_history.size()) {
 
     _current_history_index++;
 
@@ -264,9 +270,7 @@ void Game::showNext() {
       }
     }
 
-    auto opt = _board_manager->makeBoardFromFen(*fen);
-    auto&& [board, state] = *opt;
-
-    _board_model.setBoard(chess::to_array(board));
+    auto board = _board_history[_current_history_index];
+    _board_model.setBoard(std::move(board));
   }
 }
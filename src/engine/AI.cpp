@@ -1,277 +1,967 @@
 #include "engine/AI.hxx"
 
-#include <mutex>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <thread>
 #include <ranges>
-#include <QDebug>
+
+#include "engine/Log.hxx"
 
 namespace chess {
 
+namespace {
+
+  // late move reductions by [depth][moves searched], growing with the
+  // log of both
+  const auto lmr_table = [] {
+    std::array<std::array<int, 64>, 64> result {};
+
+    for (int depth = 1; depth < 64; depth++) {
+      for (int moves = 1; moves < 64; moves++) {
+        result[depth][moves] =
+          static_cast<int>(0.75 + std::log(depth) * std::log(moves) / 2.25);
+      }
+    }
+
+    return result;
+  }();
+
+} // namespace
+
+/******************************************************************************
+ *
+ * Method: AI::lmrReduction(int depth, int moves_searched)
+ *
+ *****************************************************************************/
+int AI::lmrReduction(int depth, int moves_searched)
+{
+  return lmr_table[std::min(depth, 63)][std::min(moves_searched, 63)];
+}
+
 /******************************************************************************
  *
  * Method: AI::AI()
  *
  *****************************************************************************/
 AI::AI(const MoveGenerator* g, AIConfig c)
-  : _generator(g)
+  : cfg(c)
+  , _generator(g)
 {
   _white_eval = 0;
   _black_eval = 0;
   _white_material_score = 0;
   _black_material_score = 0;
 
-  switch (cfg.difficulty) {
+  setThreads(4);
+}
 
-    case AIDifficulty::Easy:
-      _depth = 1;
-      break;
+/******************************************************************************
+ *
+ * Method: AI::~AI()
+ *
+ *****************************************************************************/
+AI::~AI()
+{
+  shutdownThreads();
+}
 
-    case AIDifficulty::Medium:
-      _depth = 3;
-      break;
+/******************************************************************************
+ *
+ * Method: AI::setThreads(size_t n)
+ *
+ *****************************************************************************/
+void AI::setThreads(size_t n)
+{
+  shutdownThreads();
 
-    case AIDifficulty::Hard:
-      _depth = 5;
-      break;
+  _quit = false;
+
+  for (auto i : util::range(std::max<size_t>(n, 1))) {
+    _threads.push_back(std::make_unique<SearchThread>());
+    _threads.back()->id = i;
+    _threads.back()->search_id = _search_id;
   }
 
-  cfg = c;
+  // started once everything is in place, the threads read _threads
+  for (auto& t : _threads) {
+    t->thread = std::thread(&AI::idleLoop, this, std::ref(*t));
+  }
 }
 
 /******************************************************************************
  *
- * Method: AI::calcMaterialScore(const BoardManager&, Color c)
+ * Method: AI::shutdownThreads()
  *
  *****************************************************************************/
-std::pair<int,int> AI::calcMaterialScore(const BoardManager& b) const
+void AI::shutdownThreads()
 {
-  int white_eval = 0;
-  int black_eval = 0;
+  stop();
+  wait();
 
-  for (auto p : chess::WhitePieces)
   {
-    white_eval +=
-        piece_values.at(p) * b.pieceCount(p);
+    std::lock_guard lock(_pool_mutex);
+    _quit = true;
   }
+  _start_cv.notify_all();
 
-  for (auto p : chess::BlackPieces)
-  {
-    black_eval +=
-        piece_values.at(p) * b.pieceCount(p);
+  for (auto& t : _threads) {
+    if (t->thread.joinable()) {
+      t->thread.join();
+    }
   }
 
-  return std::make_pair(white_eval, black_eval);
+  _threads.clear();
 }
 
 /******************************************************************************
  *
- * Method: AI::calcPositionalScore(const BoardManager&)
+ * Method: AI::idleLoop(SearchThread&)
  *
  *****************************************************************************/
-int AI::calcPositionalScore(const BoardManager& b, Color side_to_move)
+void AI::idleLoop(SearchThread& t)
 {
-  int white_position_score = 0;
-  int black_position_score = 0;
-
-  for (auto square : util::range(NoSquare)) {
-    if (auto piece = b.pieceAt(square)) {
-      int score = positional_map[*piece][square];
+  while (true) {
+    {
+      std::unique_lock lock(_pool_mutex);
+      _start_cv.wait(lock, [&] { return _quit || _search_id != t.search_id; });
 
-      if (*piece < BlackPawn) {
-        white_position_score += score;
-      } else {
-        black_position_score += score;
+      if (_quit) {
+        return;
       }
+
+      t.search_id = _search_id;
     }
-  }
 
-  return side_to_move == White ? white_position_score - black_position_score
-                               : black_position_score - white_position_score;
+    if (t.id == 0) {
+      mainSearch(t);
+    }
+    else if (!_root_moves.empty()) {
+      iterativeDeepening(t);
+    }
+
+    {
+      std::lock_guard lock(_pool_mutex);
+      _searching--;
+    }
+    _done_cv.notify_all();
+  }
 }
 
 /******************************************************************************
  *
- * Method: AI::evaluate(const BoardManager&, Color c)
+ * Method: AI::nodes()
  *
  *****************************************************************************/
-int AI::evaluate(MoveResult last_move, const BoardManager& b, int depth)
+uint64_t AI::nodes() const
 {
-  int material_score = 0;
+  uint64_t total = 0;
 
-  auto side_to_move = b.getSideToMove();
-  auto [white_mat, black_mat] = calcMaterialScore(b);
+  for (const auto& t : _threads) {
+    total += t->nodes.load(std::memory_order_relaxed);
+  }
 
-  switch (side_to_move) {
-    case White:
-      material_score = white_mat - black_mat;
-      break;
+  return total;
+}
 
-    case Black:
-      material_score = black_mat - white_mat;
+/******************************************************************************
+ *
+ * Method: AI::maxDepth()
+ * cfg can change between searches so this is not cached
+ *****************************************************************************/
+int AI::maxDepth() const
+{
+  switch (cfg.difficulty) {
+
+    case AIDifficulty::Easy:
+      return 2;
+
+    case AIDifficulty::Medium:
+      return 4;
+
+    case AIDifficulty::Hard:
       break;
   }
 
+  // as deep as the time allows
+  return MaxDepth;
+}
+
+/******************************************************************************
+ *
+ * Method: AI::evaluate(MoveResult, const BoardManager&, int ply)
+ * scores the position from the point of view of the side to move
+ *****************************************************************************/
+int AI::evaluate(MoveResult last_move, const BoardManager& b, int ply)
+{
+  auto side_to_move = b.getSideToMove();
+
   if (last_move == MoveResult::Checkmate) {
-    return color() == side_to_move ? -100'000 * depth : 100'000 * depth;
+    return -MateScore + ply;
 
   } else if (last_move == MoveResult::Stalemate) {
-    return -10000;
+    // a draw, scored like repetitions and the fifty move rule
+    return 0;
+  }
+
+  // all of these are kept up to date by the board as moves are made
+  const int score = b.material(White) - b.material(Black) +
+                    eval::taper(b.positional(White) - b.positional(Black), b.phase());
+
+  return side_to_move == White ? score : -score;
+}
+
+/******************************************************************************
+ *
+ * Method: AI::scoreToTT(int score, int ply)
+ *
+ *****************************************************************************/
+int AI::scoreToTT(int score, int ply)
+{
+  if (score >= MateBound) {
+    return score + ply;
+  }
+  if (score <= -MateBound) {
+    return score - ply;
+  }
+  return score;
+}
+
+/******************************************************************************
+ *
+ * Method: AI::scoreFromTT(int score, int ply)
+ *
+ *****************************************************************************/
+int AI::scoreFromTT(int score, int ply)
+{
+  if (score >= MateBound) {
+    return score - ply;
   }
+  if (score <= -MateBound) {
+    return score + ply;
+  }
+  return score;
+}
 
-  return material_score + calcPositionalScore(b, side_to_move);
+/******************************************************************************
+ *
+ * Method: AI::shouldStop(SearchThread&)
+ *
+ *****************************************************************************/
+bool AI::shouldStop(SearchThread& t)
+{
+  if (_stop.load(std::memory_order_relaxed)) {
+    return true;
+  }
+
+  // only this thread writes its counter, no need for an atomic add
+  uint64_t nodes = t.nodes.load(std::memory_order_relaxed) + 1;
+  t.nodes.store(nodes, std::memory_order_relaxed);
+
+  // the main thread checks the limits every so often,
+  // reading the clock is not free
+  if (t.id == 0 && (nodes & 1023) == 0) {
+    if ((_node_limit && this->nodes() >= _node_limit) ||
+        (_deadline && std::chrono::steady_clock::now() >= *_deadline))
+    {
+      _stop = true;
+    }
+  }
+
+  return _stop.load(std::memory_order_relaxed);
 }
 
 /******************************************************************************
  *
- * Method: AI::miniMax(BoardManager m, HashedMove, depth )
+ * Method: AI::negaMax(SearchThread&, BoardManager&, int alpha, int beta,
+ *                     int depth, int ply)
  *
  *****************************************************************************/
-int AI::miniMax(MoveResult last, BoardManager& m, int alpha, int beta, int cur_depth, bool is_max)
+int AI::negaMax(SearchThread& t, BoardManager& m,
+                int alpha, int beta, int depth, int ply)
 {
-  if (cur_depth == 0 ||
-      last == MoveResult::Checkmate ||
-      last == MoveResult::Stalemate)
+  const bool in_check = m.inCheck();
+
+  // checks are searched a ply deeper so forcing lines are seen through
+  if (in_check) {
+    depth++;
+  }
+
+  // leaves are resolved by a capture search, which counts the node
+  if (depth == 0) {
+    return quiesce(t, m, alpha, beta, ply);
+  }
+
+  t.pv_length[ply] = ply;
+  t.seldepth = std::max(t.seldepth, ply);
+
+  // endless checks can't take the search past the end of its tables
+  if (ply >= MaxPly - 1) {
+    return in_check ? 0 : evaluate(MoveResult::Valid, m, ply);
+  }
+
+  // either side can steer back into a repeated position, so the first
+  // repetition already counts as a draw
+  if (m.isRepetition()) {
+    return 0;
+  }
+
+  // a mate on the hundredth half move still counts, so in check the
+  // fifty move rule only applies once there is a legal reply
+  if (m.isFiftyMoveDraw()) {
+    if (!in_check) {
+      return 0;
+    }
+
+    MoveList evasions;
+    m.generateMoves(evasions);
+
+    if (!evasions.empty()) {
+      return 0;
+    }
+  }
+
+  // the result of a stopped search is thrown away
+  if (shouldStop(t)) {
+    return 0;
+  }
+
+  // a mate found closer to the root can't be beaten from here
+  alpha = std::max(alpha, -MateScore + ply);
+  beta = std::min(beta, MateScore - ply - 1);
+
+  if (alpha >= beta) {
+    return alpha;
+  }
+
+  // only nodes searched with an open window can be on the principal
+  // variation, the rest just have to prove a move fails low or high
+  const bool pv_node = beta - alpha > 1;
+  const int original_alpha = alpha;
+  const auto key = m.getHash();
+
+  PackedMove tt_move;
+
+  if (auto entry = _tt.probe(key)) {
+    tt_move = entry->move;
+    const int score = scoreFromTT(entry->score, ply);
+
+    if (!pv_node && entry->depth >= depth &&
+        (entry->bound == Bound::Exact ||
+         (entry->bound == Bound::Lower && score >= beta) ||
+         (entry->bound == Bound::Upper && score <= alpha)))
+    {
+      return score;
+    }
+  }
+
+  const Color side = m.getSideToMove();
+  const auto& search = cfg.search;
+
+  // none of the pruning below is safe in check or on the principal
+  // variation, where the exact score matters
+  const bool can_prune = !pv_node && !in_check;
+  const int static_eval = can_prune ? evaluate(MoveResult::Valid, m, ply) : 0;
+
+  // so far above beta that a quiet move won't bring it back down
+  if (can_prune && search.futility && depth <= search.futility_depth &&
+      std::abs(beta) < MateBound &&
+      static_eval - search.futility_margin * depth >= beta)
   {
-    return evaluate(last, m, cur_depth);
+    return static_eval;
   }
 
-  auto legal_moves = getLegalMoves(m);
+  // if passing still fails high a real move would as well. without
+  // pieces passing is often the best move, so it can't be trusted there
+  if (can_prune && search.null_move && depth >= 2 &&
+      static_eval >= beta && !m.lastMoveWasNull() &&
+      m.hasNonPawnMaterial(side))
+  {
+    const int reduction = search.null_move_reduction + depth / 4;
+
+    m.makeNullMove();
+    int score = -negaMax(t, m, -beta, -beta + 1,
+                         std::max(depth - 1 - reduction, 0), ply + 1);
+    m.unmakeNullMove();
+
+    if (_stop) {
+      return 0;
+    }
+
+    // a mate found by passing isn't real
+    if (score >= beta) {
+      return score >= MateBound ? beta : score;
+    }
+  }
+
+  // quiets can't raise the score enough to matter, only captures,
+  // promotions and checks are searched
+  const bool futile = can_prune && search.futility &&
+                      depth <= search.futility_depth &&
+                      std::abs(alpha) < MateBound &&
+                      static_eval + search.futility_margin * depth <= alpha;
+
+  const auto& killers = t.killers[ply];
+  MovePicker picker(m, tt_move, killers, t.history);
+
+  // quiets that failed to cut off, punished if a later one does
+  MoveList quiets_tried;
+
+  HashedMove best_move;
+  best_move.hashed = 0;
+  int best = -Infinity;
+  int moves_searched = 0;
+
+  while (auto next = picker.next()) {
+    const auto move = *next;
+    const bool quiet = !move.m.capture && !move.m.promoted;
+
+    // Apply the move
+    m.makeMove(move);
 
-  if (is_max) {
-    int maxEval = std::numeric_limits<int>::min();
-    // Loop through possible moves and apply them
-    for (const auto& move : legal_moves) {
+    const bool gives_check = m.inCheck();
 
-      // Apply the move
-      BoardManager temp(_generator, m._board, m._state, legal_moves);
+    if (futile && quiet && !gives_check && moves_searched > 0) {
+      m.unmakeMove();
+      continue;
+    }
+
+    _tt.prefetch(m.getHash());
+
+    int score;
+
+    if (moves_searched == 0) {
+      score = -negaMax(t, m, -beta, -alpha, depth - 1, ply + 1);
+    }
+    else {
+      int reduction = 0;
+
+      // late quiets rarely turn out best, more so the deeper and later
+      // they come. killers and moves with a good history are trusted more
+      if (search.late_move_reductions && quiet && !in_check && !gives_check &&
+          depth >= search.lmr_min_depth &&
+          moves_searched >= search.lmr_full_depth_moves &&
+          PackedMove(move) != killers[0] && PackedMove(move) != killers[1])
+      {
+        reduction = lmrReduction(depth, moves_searched);
+        reduction -= t.history[side][move.m.source][move.m.target] / (MaxHistoryScore / 2);
+        reduction -= pv_node ? 1 : 0;
+        reduction = std::clamp(reduction, 0, std::max(depth - 2, 0));
+      }
 
-      auto&& [result, u] = temp.tryMove(move.toMove());
+      score = -negaMax(t, m, -alpha - 1, -alpha, depth - 1 - reduction, ply + 1);
+
+      if (reduction > 0 && score > alpha) {
+        score = -negaMax(t, m, -alpha - 1, -alpha, depth - 1, ply + 1);
+      }
+
+      if (score > alpha && score < beta) {
+        score = -negaMax(t, m, -beta, -alpha, depth - 1, ply + 1);
+      }
+    }
 
-      maxEval = std::max(maxEval, miniMax(result, temp, alpha, beta, cur_depth - 1, false));
-      alpha = std::max(alpha, maxEval);
+    m.unmakeMove();
+    moves_searched++;
 
-      if (beta <= alpha) {
+    if (score > best) {
+      best = score;
+      best_move = move;
+    }
+
+    if (best > alpha) {
+      alpha = best;
+
+      if (pv_node) {
+        updatePv(t, move, ply);
+      }
+
+      if (alpha >= beta) {
+        if (quiet && !_stop) {
+          updateQuietStats(t, side, move, quiets_tried, depth, ply);
+        }
         break;
       }
     }
-    return maxEval;
+
+    if (quiet) {
+      quiets_tried.push_back(move);
+    }
+  }
+
+  // no legal moves
+  if (best_move.hashed == 0) {
+    return evaluate(m.inCheck() ? MoveResult::Checkmate : MoveResult::Stalemate,
+                    m, ply);
+  }
+
+  if (_stop) {
+    return 0;
+  }
+
+  const Bound bound = best <= original_alpha ? Bound::Upper
+                    : best >= beta           ? Bound::Lower
+                                             : Bound::Exact;
+
+  _tt.store(key, PackedMove(best_move), scoreToTT(best, ply), depth, bound);
+
+  return best;
+}
+
+/******************************************************************************
+ *
+ * Method: AI::updateQuietStats(SearchThread&, Color, const HashedMove&,
+ *                              const MoveList&, int depth, int ply)
+ *
+ *****************************************************************************/
+void AI::updateQuietStats(SearchThread& t, Color side, const HashedMove& move,
+                          const MoveList& quiets_tried, int depth, int ply)
+{
+  auto& killers = t.killers[ply];
+  const PackedMove packed(move);
+
+  if (killers[0] != packed) {
+    killers[1] = killers[0];
+    killers[0] = packed;
+  }
+
+  // deeper cutoffs say more about the move
+  const int bonus = std::min(depth * depth, MaxHistoryScore / 4);
+
+  update_history(t.history, side, move, bonus);
+
+  for (const auto& tried : quiets_tried) {
+    update_history(t.history, side, tried, -bonus);
+  }
+}
+
+/******************************************************************************
+ *
+ * Method: AI::quiesce(SearchThread&, BoardManager&, int alpha, int beta, int ply)
+ * search captures and promotions until the position is quiet, so leaves
+ * are not scored in the middle of an exchange
+ *****************************************************************************/
+int AI::quiesce(SearchThread& t, BoardManager& m,
+                int alpha, int beta, int ply)
+{
+  t.pv_length[ply] = ply;
+  t.seldepth = std::max(t.seldepth, ply);
+
+  if (shouldStop(t)) {
+    return 0;
+  }
+
+  const bool in_check = m.inCheck();
+  int best = -Infinity;
+
+  if (ply >= MaxPly - 1) {
+    return in_check ? 0 : evaluate(MoveResult::Valid, m, ply);
+  }
+
+  // in check every evasion has to be looked at and standing pat is not
+  // an option, otherwise the side to move can decline all captures.
+  // a capture that loses material can't improve on standing pat, so
+  // the picker leaves those out
+  std::optional<MovePicker> picker;
+
+  if (in_check) {
+    picker.emplace(m, PackedMove(), Killers {}, t.history);
   }
   else {
-    int minEval = std::numeric_limits<int>::max();
-    for (const auto& move : legal_moves) {
+    const int stand_pat = evaluate(MoveResult::Valid, m, ply);
 
-      // Apply the move
-      BoardManager temp(_generator, m._board, m._state, legal_moves);
+    if (stand_pat >= beta) {
+      return stand_pat;
+    }
 
-      auto&& [result, u] = temp.tryMove(move.toMove());
+    best = stand_pat;
+    alpha = std::max(alpha, stand_pat);
 
-      minEval = std::min(minEval, miniMax(result, temp, alpha, beta, cur_depth - 1, true));
-      beta = std::min(beta, minEval);
+    picker.emplace(m);
+  }
 
-      if (beta <= alpha) {
-        break;
+  bool searched = false;
+
+  while (auto move = picker->next()) {
+    searched = true;
+
+    m.makeMove(*move);
+    int score = -quiesce(t, m, -beta, -alpha, ply + 1);
+    m.unmakeMove();
+
+    if (score > best) {
+      best = score;
+
+      if (score > alpha) {
+        alpha = score;
+
+        if (alpha >= beta) {
+          break;
+        }
       }
     }
-    return minEval;
   }
+
+  if (in_check && !searched) {
+    return evaluate(MoveResult::Checkmate, m, ply);
+  }
+
+  return best;
+}
+
+/******************************************************************************
+ *
+ * Method: AI::getLegalMoves(BoardManager& m)
+ *
+ *****************************************************************************/
+MoveList AI::getLegalMoves(BoardManager& m)
+{
+  MoveList legal_moves;
+  PackedMove tt_move;
+
+  if (auto entry = _tt.probe(m.getHash())) {
+    tt_move = entry->move;
+  }
+
+  // the search threads are parked, so the main thread's history is free
+  MovePicker picker(m, tt_move, Killers {}, _threads[0]->history);
+
+  while (auto move = picker.next()) {
+    legal_moves.push_back(*move);
+  }
+
+  return legal_moves;
 }
 
 /******************************************************************************
  *
- * Method: AI::getLegalMoves(const BoardManager& cpy)
+ * Method: AI::allocateTime(const SearchLimits&, Color us)
  *
  *****************************************************************************/
-std::vector<HashedMove> AI::getLegalMoves(const BoardManager& cpy)
+std::optional<std::chrono::milliseconds>
+AI::allocateTime(const SearchLimits& limits, Color us)
 {
-  std::vector<HashedMove> legal_moves = {};
+  using std::chrono::milliseconds;
 
-  for (const auto m : cpy._move_list) {
+  const auto start = _start_time;
 
-    BoardManager temp(_generator, cpy._board, cpy._state, cpy._move_list);
+  _deadline.reset();
 
-    if (auto&& [result, move] = temp.tryMove(m.toMove());
-        result != MoveResult::Illegal)
-    {
-      legal_moves.push_back(m);
+  if (limits.move_time) {
+    auto budget = std::max(milliseconds(limits.move_time) - MoveOverhead, milliseconds(1));
+    _deadline = start + budget;
+    return std::nullopt;
+  }
+
+  if (limits.time[us]) {
+    auto left = std::max(milliseconds(limits.time[us]) - MoveOverhead, milliseconds(1));
+    int moves_to_go = limits.moves_to_go ? std::min(limits.moves_to_go, 50) : 30;
+
+    // aim for an even share of the clock plus most of the increment,
+    // allow overrunning it when an iteration is already under way
+    auto optimum = std::min(left / moves_to_go + milliseconds(limits.increment[us]) * 3 / 4,
+                            left);
+    auto maximum = std::min(optimum * 3, left);
+
+    _deadline = start + maximum;
+    return optimum;
+  }
+
+  if (!limits.infinite && !limits.depth && !limits.nodes) {
+    _deadline = start + DefaultMoveTime;
+  }
+
+  return std::nullopt;
+}
+
+/******************************************************************************
+ *
+ * Method: AI::searchRoot(SearchThread&, BoardManager&, MoveList&, int depth,
+ *                        int alpha, int beta)
+ *
+ *****************************************************************************/
+std::optional<int> AI::searchRoot(SearchThread& t,
+                                  BoardManager& board,
+                                  MoveList& root_moves,
+                                  int depth, int alpha, int beta)
+{
+  int best = -Infinity;
+  size_t best_index = 0;
+
+  t.pv_length[0] = 0;
+
+  for (auto i : util::range(root_moves.size())) {
+    board.makeMove(root_moves[i]);
+
+    int score;
+
+    if (i == 0) {
+      score = -negaMax(t, board, -beta, -alpha, depth - 1, 1);
+    }
+    else {
+      score = -negaMax(t, board, -alpha - 1, -alpha, depth - 1, 1);
+
+      if (score > alpha && score < beta) {
+        score = -negaMax(t, board, -beta, -alpha, depth - 1, 1);
+      }
+    }
+
+    board.unmakeMove();
+
+    // an unfinished iteration may have missed a better move
+    if (_stop) {
+      return std::nullopt;
+    }
+
+    if (score > best) {
+      best = score;
+
+      // when every move fails low their order says nothing
+      if (score > alpha) {
+        best_index = i;
+        alpha = score;
+        updatePv(t, root_moves[i], 0);
+
+        if (alpha >= beta) {
+          break;
+        }
+      }
     }
   }
 
-  std::ranges::sort(legal_moves, [](auto& a, auto& b) {
-    return static_cast<bool>(a.m.capture);
-  });
+  // searched first in the next iteration
+  std::rotate(root_moves.begin(), root_moves.begin() + best_index,
+              root_moves.begin() + best_index + 1);
 
-  return legal_moves;
+  return best;
 }
 
 /******************************************************************************
  *
- * Method: AI::getBestMove()
+ * Method: AI::updatePv(SearchThread&, const HashedMove&, int ply)
  *
  *****************************************************************************/
-std::optional<HashedMove> AI::getBestMove(const BoardManager& cpy)
+void AI::updatePv(SearchThread& t, const HashedMove& move, int ply)
 {
-  std::mutex mtx;
-  auto startTime = std::chrono::high_resolution_clock::now();
+  auto& line = t.pv[ply];
+  const auto& below = t.pv[ply + 1];
 
-  auto legal_moves = getLegalMoves(cpy);
-  std::vector<std::pair<HashedMove, int>> move_scores = {};
+  line[ply] = move;
 
-  if (legal_moves.size()) {
-    constexpr size_t num_threads = 4;
-    const size_t items_per_thread = legal_moves.size() / num_threads;
+  for (int i = ply + 1; i < t.pv_length[ply + 1]; i++) {
+    line[i] = below[i];
+  }
 
-    auto process = [&] (int thread_num,
-                        std::vector<HashedMove>::iterator begin,
-                        std::vector<HashedMove>::iterator end) -> void
-    {
-      std::vector<std::pair<HashedMove, int>> ret;
-
-      for (auto it = begin; it != end; ++it) {
-        BoardManager initial_board (_generator, cpy._board, cpy._state, legal_moves);
-        auto&& [result, move_made] = initial_board.tryMove(it->toMove());
-        ret.push_back({*it,
-                       miniMax(result, initial_board,
-                               std::numeric_limits<int>::min(),
-                               std::numeric_limits<int>::max(), 5, false)});
+  t.pv_length[ply] = std::max(t.pv_length[ply + 1], ply + 1);
+}
+
+/******************************************************************************
+ *
+ * Method: AI::iterativeDeepening(SearchThread&)
+ *
+ *****************************************************************************/
+SearchResult AI::iterativeDeepening(SearchThread& t)
+{
+  // each thread walks its own copy of the board
+  BoardManager board = *_root;
+  MoveList root_moves = _root_moves;
+
+  // played if not even the first iteration completes
+  SearchResult result;
+  result.pv = { root_moves[0] };
+
+  // killers belong to the positions of the last search, the history
+  // still says something about this one so it is only faded
+  t.killers = {};
+  for (auto& from : t.history) {
+    for (auto& to : from) {
+      for (auto& entry : to) {
+        entry /= 2;
       }
+    }
+  }
+
+  std::optional<int> score;
+
+  // helpers start one ply deeper every other thread so that they fill
+  // the table ahead of the main thread instead of repeating its work
+  for (int depth = 1 + (t.id & 1); depth <= _max_depth; depth++) {
+    int window = AspirationWindow;
+    int alpha = -Infinity;
+    int beta = Infinity;
+
+    t.seldepth = 0;
+
+    // the score rarely moves far between iterations, a narrow window
+    // around the last one cuts more. mates are searched in full
+    if (score && std::abs(*score) < MateBound) {
+      alpha = *score - window;
+      beta = *score + window;
+    }
 
-      mtx.lock();
-      move_scores.insert(move_scores.end(), ret.begin(), ret.end());
-      mtx.unlock();
-    };
+    // widen the side that failed until the score falls inside
+    while (true) {
+      score = searchRoot(t, board, root_moves, depth, alpha, beta);
 
-    std::vector<std::thread> threads;
+      if (!score) {
+        break;
+      }
 
-    for (auto i : util::range(num_threads)) {
+      if (*score <= alpha) {
+        alpha = std::max(*score - window, -Infinity);
+      }
+      else if (*score >= beta) {
+        beta = std::min(*score + window, Infinity);
+      }
+      else {
+        break;
+      }
 
-      auto begin = std::begin(legal_moves) + i * items_per_thread;
-      auto end = (i == num_threads - 1) ? std::end(legal_moves) : begin + items_per_thread;
-      threads.emplace_back(process, i, begin, end);
+      window *= 2;
     }
 
-    for (auto& t : threads) {
-      t.join();
+    // stay with the last iteration that completed
+    if (!score) {
+      break;
     }
 
-    std::ranges::sort(move_scores, [&](const auto& a, const auto& b) {
-      return a.second > b.second;
-    });
+    result.pv.assign(t.pv[0].begin(), t.pv[0].begin() + t.pv_length[0]);
+    result.depth = depth;
+    result.seldepth = t.seldepth;
+    result.nodes = nodes();
+    result.score = *score;
+    result.mate = *score >= MateBound  ? (MateScore - *score + 1) / 2
+                : *score <= -MateBound ? -(MateScore + *score) / 2
+                                       : 0;
+    result.time = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - _start_time);
+
+    // nothing to choose between
+    if (root_moves.size() == 1) {
+      break;
+    }
 
-    auto endTime = std::chrono::high_resolution_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::seconds>(endTime - startTime);
+    if (t.id != 0) {
+      continue;
+    }
 
-    qDebug() << "findBestMove executed in " << duration.count() << " second(s).\n";
+    if (_on_info) {
+      _on_info(result);
+    }
+    else {
+      std::string line;
+      for (const auto& move : result.pv) {
+        line += " " + to_uci_string(move);
+      }
 
-    for (auto [m, score] : move_scores) {
-      qDebug() << to_string(m) << " " << score;
+      log::write("depth " + std::to_string(depth) +
+                 " seldepth " + std::to_string(result.seldepth) +
+                 " score " + std::to_string(result.score) +
+                 " nodes " + std::to_string(result.nodes) +
+                 " time " + std::to_string(result.time.count()) + "ms" +
+                 " pv" + line);
     }
 
-    return move_scores.front().first;
+    // the next iteration would take longer than the time that is left
+    if (_soft_limit && result.time >= *_soft_limit / 2) {
+      break;
+    }
   }
-  else {
-    // was checkmate or stalemate
-    return std::nullopt;
+
+  return result;
+}
+
+/******************************************************************************
+ *
+ * Method: AI::mainSearch(SearchThread&)
+ *
+ *****************************************************************************/
+void AI::mainSearch(SearchThread& t)
+{
+  // no moves means checkmate or stalemate
+  _result = _root_moves.empty() ? SearchResult {} : iterativeDeepening(t);
+
+  // the main thread decides when the search is over
+  _stop = true;
+
+  {
+    std::unique_lock lock(_pool_mutex);
+    _done_cv.wait(lock, [this] { return _searching == 1; });
+  }
+
+  auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - _start_time);
+
+  log::write("findBestMove executed in " + std::to_string(duration.count()) + " ms.");
+
+  if (_on_done) {
+    _on_done(_result);
+  }
+}
+
+/******************************************************************************
+ *
+ * Method: AI::startSearch(const BoardManager&, const SearchLimits&,
+ *                         SearchCallback, SearchCallback)
+ *
+ *****************************************************************************/
+void AI::startSearch(const BoardManager& cpy,
+                     const SearchLimits& limits,
+                     SearchCallback on_done,
+                     SearchCallback on_info)
+{
+  wait();
+
+  std::lock_guard lock(_pool_mutex);
+
+  // cleared before returning so a stop() from the caller can't be lost
+  _stop = false;
+  _start_time = std::chrono::steady_clock::now();
+  _node_limit = limits.nodes;
+  _tt.newSearch();
+
+  for (auto& t : _threads) {
+    t->nodes = 0;
   }
+
+  const Color us = cpy.getSideToMove();
+  _soft_limit = allocateTime(limits, us);
+  _max_depth = limits.depth ? std::min(limits.depth, MaxDepth) : maxDepth();
+
+  _root.emplace(cpy);
+  _root_moves = getLegalMoves(*_root);
+  _on_done = std::move(on_done);
+  _on_info = std::move(on_info);
+  _result = {};
+
+  _searching = _threads.size();
+  _search_id++;
+
+  _start_cv.notify_all();
+}
+
+/******************************************************************************
+ *
+ * Method: AI::wait()
+ *
+ *****************************************************************************/
+SearchResult AI::wait()
+{
+  std::unique_lock lock(_pool_mutex);
+  _done_cv.wait(lock, [this] { return _searching == 0; });
+
+  return _result;
+}
+
+/******************************************************************************
+ *
+ * Method: AI::getBestMove()
+ *
+ *****************************************************************************/
+SearchResult AI::getBestMove(const BoardManager& cpy,
+                             const SearchLimits& limits)
+{
+  startSearch(cpy, limits);
+  return wait();
 }
 
 } // namespace chess
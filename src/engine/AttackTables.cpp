@@ -0,0 +1,450 @@
+#include "engine/AttackTables.hxx"
+
+#include <algorithm>
+
+#include "engine/ChessUtil.hxx"
+#include "engine/Util.hxx"
+
+namespace chess::tables {
+
+namespace {
+
+/*******************************************************************************
+ *
+ * Function: calc_bishop_attacks(uint8_t square, Bitboard occ)
+ *
+ *******************************************************************************/
+constexpr Bitboard calc_bishop_attacks(uint8_t square, Bitboard occ)
+{
+  Bitboard attacks {0ULL};
+
+  int r, f;
+  int tr = square / 8;
+  int tf = square % 8;
+
+  for (r = tr + 1, f = tf + 1; r <= 7 && f <= 7; r++, f++) {
+    set_bit(r * 8 + f, attacks);
+    if (is_set(r * 8 + f, occ)) break;
+  }
+  for (r = tr - 1, f = tf + 1; r >= 0 && f <= 7; r--, f++) {
+    set_bit(r * 8 + f, attacks);
+    if (is_set(r * 8 + f, occ)) break;
+  }
+  for (r = tr + 1, f = tf - 1; r <= 7 && f >= 0; r++, f--) {
+    set_bit(r * 8 + f, attacks);
+    if (is_set(r * 8 + f, occ)) break;
+  }
+  for (r = tr - 1, f = tf - 1; r >= 0 && f >= 0; r--, f--) {
+    set_bit(r * 8 + f, attacks);
+    if (is_set(r * 8 + f, occ)) break;
+  }
+
+  return attacks;
+}
+
+/*******************************************************************************
+ *
+ * Function: calc_rook_attacks(uint8_t square, Bitboard occ)
+ *
+ *******************************************************************************/
+constexpr Bitboard calc_rook_attacks(uint8_t square, Bitboard occ)
+{
+  Bitboard attacks {0ULL};
+
+  int r = 0;
+  int f = 0;
+  int tr = square / 8;
+  int tf = square % 8;
+
+  for (r = tr + 1; r <= 7; r++) {
+    set_bit(r * 8 + tf, attacks);
+    if (is_set(r * 8 + tf, occ)) break;
+  }
+  for (r = tr - 1; r >= 0; r--) {
+    set_bit(r * 8 + tf, attacks);
+    if (is_set(r * 8 + tf, occ)) break;
+  }
+  for (f = tf + 1; f <= 7; f++) {
+    set_bit(tr * 8 + f, attacks);
+    if (is_set(tr * 8 + f, occ)) break;
+  }
+  for (f = tf - 1; f >= 0; f--) {
+    set_bit(tr * 8 + f, attacks);
+    if (is_set(tr * 8 + f, occ)) break;
+  }
+
+  return attacks;
+}
+
+/*******************************************************************************
+ *
+ * Function: init_pawn_attacks()
+ *
+ *******************************************************************************/
+constexpr std::array<SquareTable, 2> init_pawn_attacks()
+{
+  std::array<SquareTable, 2> result {};
+
+  constexpr auto get_mask = []<Color C>(uint8_t square) {
+    Bitboard attacks {0ULL};
+    Bitboard b {0ULL};
+
+    set_bit(square, b);
+
+    if constexpr (C == White) {
+      if ((b << 7) & not_h_file)
+        attacks |= (b << 7);
+
+      if ((b << 9) & not_a_file)
+        attacks |= (b << 9);
+
+    }
+    else {
+      if ((b >> 7) & not_a_file)
+        attacks |= (b >> 7);
+
+      if ((b >> 9) & not_h_file)
+        attacks |= (b >> 9);
+    }
+
+    return attacks;
+  };
+
+  for (const auto i : util::range(NoSquare)) {
+    result[White][i] = get_mask.template operator()<White>(i);
+    result[Black][i] = get_mask.template operator()<Black>(i);
+  }
+
+  return result;
+}
+
+/*******************************************************************************
+ *
+ * Function: init_knight_attacks()
+ *
+ *******************************************************************************/
+constexpr SquareTable init_knight_attacks()
+{
+  SquareTable result {};
+
+  for (auto square : util::range(NoSquare)) {
+    Bitboard attacks {0ULL};
+    Bitboard b {0ULL};
+
+    set_bit(square, b);
+
+    if ((b << 17) & not_a_file)
+      attacks |= b << 17;
+    if ((b << 15) & not_h_file)
+      attacks |= b << 15;
+    if ((b << 10) & not_ab_file)
+      attacks |= b << 10;
+    if ((b << 6) & not_hg_file)
+      attacks |= b << 6;
+    if ((b >> 17) & not_h_file)
+      attacks |= b >> 17;
+    if ((b >> 15) & not_a_file)
+      attacks |= b >> 15;
+    if ((b >> 10) & not_hg_file)
+      attacks |= b >> 10;
+    if ((b >> 6) & not_ab_file)
+      attacks |= b >> 6;
+
+    result[square] = attacks;
+  }
+  return result;
+}
+
+/*******************************************************************************
+ *
+ * Function: init_king_attacks()
+ *
+ *******************************************************************************/
+constexpr SquareTable init_king_attacks()
+{
+  SquareTable result {};
+
+  for (const auto square : util::range(NoSquare)) {
+    Bitboard attacks {0ULL};
+    Bitboard b {0ULL};
+
+    set_bit(square, b);
+
+    if ((b << 8))
+      attacks |= b << 8;
+    if ((b << 9) & not_a_file)
+      attacks |= b << 9;
+    if ((b << 7) & not_h_file)
+      attacks |= b << 7;
+    if ((b << 1) & not_a_file)
+      attacks |= b << 1;
+
+    if ((b >> 8))
+      attacks |= b >> 8;
+    if ((b >> 9) & not_h_file)
+      attacks |= b >> 9;
+    if ((b >> 7) & not_a_file)
+      attacks |= b >> 7;
+    if ((b >> 1) & not_h_file)
+      attacks |= b >> 1;
+
+    result[square] = attacks;
+  }
+
+  return result;
+}
+
+/*******************************************************************************
+ *
+ * Function: init_bishop_masks()
+ *
+ *******************************************************************************/
+constexpr SquareTable init_bishop_masks()
+{
+  SquareTable result {};
+
+  for (const auto square : util::range(NoSquare)) {
+    Bitboard attacks {0ULL};
+
+    int r = 0;
+    int f = 0;
+    int tr = square / 8;
+    int tf = square % 8;
+
+    for (r = tr + 1, f = tf + 1; r <= 6 && f <= 6; r++, f++) {
+      set_bit(r * 8 + f, attacks);
+    }
+    for (r = tr - 1, f = tf + 1; r >= 1 && f <= 6; r--, f++) {
+      set_bit(r * 8 + f, attacks);
+    }
+    for (r = tr + 1, f = tf - 1; r <= 6 && f >= 1; r++, f--) {
+      set_bit(r * 8 + f, attacks);
+    }
+    for (r = tr - 1, f = tf - 1; r >= 1 && f >= 1; r--, f--) {
+      set_bit(r * 8 + f, attacks);
+    }
+
+    result[square] = attacks;
+  }
+
+  return result;
+}
+
+/*******************************************************************************
+ *
+ * Function: init_rook_masks()
+ *
+ *******************************************************************************/
+constexpr SquareTable init_rook_masks()
+{
+  SquareTable result {};
+
+  for (auto square : util::range(NoSquare)) {
+    Bitboard attacks {0ULL};
+
+    int r = 0;
+    int f = 0;
+    int tr = square / 8;
+    int tf = square % 8;
+
+    for (r = tr + 1; r <= 6; r++) {
+      set_bit(r * 8 + tf, attacks);
+    }
+    for (r = tr - 1; r >= 1; r--) {
+      set_bit(r * 8 + tf, attacks);
+    }
+    for (f = tf + 1; f <= 6; f++) {
+      set_bit(tr * 8 + f, attacks);
+    }
+    for (f = tf - 1; f >= 1; f--) {
+      set_bit(tr * 8 + f, attacks);
+    }
+
+    result[square] = attacks;
+  }
+  return result;
+}
+
+/*******************************************************************************
+ *
+ * Function: init_between_masks()
+ *
+ *******************************************************************************/
+constexpr std::array<SquareTable, 64> init_between_masks()
+{
+  std::array<SquareTable, 64> result {};
+
+  for (const auto a : util::range(NoSquare)) {
+    for (const auto b : util::range(NoSquare)) {
+      Bitboard a_bit {0ULL};
+      Bitboard b_bit {0ULL};
+      set_bit(a, a_bit);
+      set_bit(b, b_bit);
+
+      // looking from each square towards the other, the rays only
+      // overlap between the two
+      if (calc_rook_attacks(a, 0ULL) & b_bit) {
+        result[a][b] = calc_rook_attacks(a, b_bit) & calc_rook_attacks(b, a_bit);
+      }
+      else if (calc_bishop_attacks(a, 0ULL) & b_bit) {
+        result[a][b] = calc_bishop_attacks(a, b_bit) & calc_bishop_attacks(b, a_bit);
+      }
+    }
+  }
+
+  return result;
+}
+
+/*******************************************************************************
+ *
+ * Function: init_line_masks()
+ *
+ *******************************************************************************/
+constexpr std::array<SquareTable, 64> init_line_masks()
+{
+  std::array<SquareTable, 64> result {};
+
+  for (const auto a : util::range(NoSquare)) {
+    for (const auto b : util::range(NoSquare)) {
+      Bitboard ends {0ULL};
+      set_bit(a, ends);
+      set_bit(b, ends);
+
+      if (a != b && (calc_rook_attacks(a, 0ULL) & ends)) {
+        result[a][b] = (calc_rook_attacks(a, 0ULL) & calc_rook_attacks(b, 0ULL)) | ends;
+      }
+      else if (a != b && (calc_bishop_attacks(a, 0ULL) & ends)) {
+        result[a][b] = (calc_bishop_attacks(a, 0ULL) & calc_bishop_attacks(b, 0ULL)) | ends;
+      }
+    }
+  }
+
+  return result;
+}
+
+/*******************************************************************************
+ *
+ * Function: init_lookup(const SquareTable&, magics, bits, uint32_t offset)
+ *
+ *******************************************************************************/
+constexpr std::array<Magic, 64> init_lookup(const SquareTable& masks,
+                                           const std::array<Bitboard, 64>& magics,
+                                           const std::array<uint8_t, 64>& bits,
+                                           uint32_t offset)
+{
+  std::array<Magic, 64> result {};
+
+  for (const auto square : util::range(NoSquare)) {
+    result[square] = { masks[square], magics[square], offset,
+                       static_cast<uint8_t>(64 - bits[square]) };
+    offset += 1U << bits[square];
+  }
+
+  return result;
+}
+
+/*******************************************************************************
+ *
+ * Function: init_slider_attacks(bishop_lookup, rook_lookup)
+ *
+ *******************************************************************************/
+// fills the attacks of every occupancy of every square's mask,
+// for both sliders
+constexpr SliderAttacks init_slider_attacks(const std::array<Magic, 64>& bishop_lookup,
+                                            const std::array<Magic, 64>& rook_lookup)
+{
+  SliderAttacks result {};
+
+  for (const auto square : util::range(NoSquare)) {
+    for (const bool is_bishop : { true, false }) {
+      const Magic& m = is_bishop ? bishop_lookup[square] : rook_lookup[square];
+
+      // walk every subset of the mask, the empty one first. this is
+      // far cheaper to evaluate at compile time than building each
+      // permutation from its index. the subsets come in the order of
+      // their pext, so the count is the pext index
+      Bitboard occupancy = 0ULL;
+      uint64_t count = 0;
+      do {
+#if defined(SUKLESS_USE_PEXT)
+        uint64_t index = count;
+#else
+        uint64_t index = (occupancy * m.magic) >> m.shift;
+#endif
+        result.attacks[m.offset + index] =
+          is_bishop ? calc_bishop_attacks(square, occupancy)
+                    : calc_rook_attacks(square, occupancy);
+
+        occupancy = (occupancy - m.mask) & m.mask;
+        count++;
+      } while (occupancy);
+    }
+  }
+
+  return result;
+}
+
+/*******************************************************************************
+ *
+ * Function: subsets_in_pext_order(const Magic& m)
+ *
+ *******************************************************************************/
+// does the subset walk of init_slider_attacks hand out the subsets of
+// the mask in the order of their pext, starting with the empty one
+constexpr bool subsets_in_pext_order(const Magic& m)
+{
+  Bitboard occupancy = 0ULL;
+  uint64_t count = 0;
+  do {
+    // pext one bit of the mask at a time
+    uint64_t index = 0;
+    uint64_t bit = 1;
+    for (Bitboard rest = m.mask; rest; rest &= rest - 1, bit <<= 1) {
+      if (occupancy & rest & -rest) {
+        index |= bit;
+      }
+    }
+
+    if (index != count) {
+      return false;
+    }
+
+    occupancy = (occupancy - m.mask) & m.mask;
+    count++;
+  } while (occupancy);
+
+  return count == 1ULL << bits::count(m.mask);
+}
+
+} // namespace
+
+constexpr std::array<SquareTable, 2> pawn_attacks = init_pawn_attacks();
+constexpr SquareTable knight_attacks = init_knight_attacks();
+constexpr SquareTable king_attacks = init_king_attacks();
+
+constexpr std::array<Magic, 64> bishop_lookup =
+  init_lookup(init_bishop_masks(), detail::bishop_magics, detail::bishop_bits, 0);
+
+constexpr std::array<Magic, 64> rook_lookup =
+  init_lookup(init_rook_masks(), detail::rook_magics, detail::rook_bits, BishopTableSize);
+
+// pext packs the occupancy into popcount(mask) bits, so the space a
+// square gets from its bits has to match its mask exactly
+static_assert(std::ranges::all_of(util::range(64), [](int sq) {
+  return bits::count(bishop_lookup[sq].mask) == detail::bishop_bits[sq] &&
+         bits::count(rook_lookup[sq].mask) == detail::rook_bits[sq];
+}));
+
+// the pext tables are indexed by the position of the occupancy in the
+// subset walk, which only works while that matches its pext
+static_assert(std::ranges::all_of(util::range(64), [](int sq) {
+  return subsets_in_pext_order(bishop_lookup[sq]) &&
+         subsets_in_pext_order(rook_lookup[sq]);
+}));
+
+constexpr SliderAttacks slider_attacks = init_slider_attacks(bishop_lookup, rook_lookup);
+
+constexpr std::array<SquareTable, 64> between = init_between_masks();
+constexpr std::array<SquareTable, 64> line = init_line_masks();
+
+} // namespace chess::tables
@@ -11,8 +11,6 @@ namespace chess {
 BoardManager::BoardManager(const MoveGenerator* g)
   : _generator(g)
 {
-  _move_list.reserve(256);
-  _history.reserve(150);
   initFromFen(chess::starting_position);
 }
 
@@ -24,26 +22,9 @@ BoardManager::BoardManager(const MoveGenerator* g)
 BoardManager::BoardManager(const MoveGenerator* g, const std::string& fen)
   : _generator(g)
 {
-  _move_list.reserve(256);
-  _history.reserve(150);
   initFromFen(fen);
 }
 
-/*******************************************************************************
- *
- * Method: BoardManager(const Board&, const BoardState&, const vec<Move>)
- * private
- *******************************************************************************/
-BoardManager::BoardManager(const MoveGenerator* g, const Board&b, const BoardState& s,
-                           const std::vector<HashedMove>& v)
-  : _board(b)
-  , _state(s)
-  , _generator(g)
-  , _move_list(v)
-  , NO_HISTORY(true)
-{
-}
-
 /*******************************************************************************
  *
  * Method: initFromFen(const std::string& fen)
@@ -52,7 +33,7 @@ BoardManager::BoardManager(const MoveGenerator* g, const Board&b, const BoardSta
 void BoardManager::initFromFen(const std::string &fen)
 {
   std::fill(_board.begin(), _board.end(), 0ULL);
-  _history.clear();
+  _ply = 0;
   _move_list.clear();
 
   if (auto val = makeBoardFromFen(fen))
@@ -60,8 +41,8 @@ void BoardManager::initFromFen(const std::string &fen)
     auto [board, state] = *val;
     _board = board;
     _state = state;
-
-    _history.push_back(generateFen());
+    _hash = zobrist::hash(_board, _state);
+    initMailbox();
 
     _generator->generateMoves(_board, _state, _move_list);
 
@@ -72,13 +53,38 @@ void BoardManager::initFromFen(const std::string &fen)
     auto&& [board, state] = *tup;
     _board = board;
     _state = state;
-
-    _history.push_back(generateFen());
+    _hash = zobrist::hash(_board, _state);
+    initMailbox();
 
     _generator->generateMoves(_board, _state, _move_list);
   }
 }
 
+/*******************************************************************************
+ *
+ * Method: initMailbox()
+ *
+ *******************************************************************************/
+void BoardManager::initMailbox()
+{
+  _mailbox.fill(NoPiece);
+  _material.fill(0);
+  _positional.fill({});
+  _phase = 0;
+
+  for (auto p : AllPieces) {
+    Bitboard pieces = _board[p];
+    while (pieces) {
+      uint8_t square = bits::get_lsb_index(pieces);
+      clear_bit(square, pieces);
+      _mailbox[square] = p;
+      _material[eval::color_of(p)] += eval::piece_values[p];
+      _positional[eval::color_of(p)] += eval::psq[p][square];
+      _phase += eval::phase_values[p];
+    }
+  }
+}
+
 /*******************************************************************************
  *
  * Method: makeBoardFromFen(const std::string& fen)
@@ -143,10 +149,9 @@ std::optional<std::pair<Board,BoardState>>
   state.side_to_move = fen_turn == "w" ? White : Black;
 
   // castling rights
-  if (fen_castling == "-") {
-    state.castling_rights = ~(util::toul(CastlingRights::WhiteCastlingRights) |
-                              util::toul(CastlingRights::BlackCastlingRights));
-  } else {
+  state.castling_rights = 0;
+
+  if (fen_castling != "-") {
     if (util::contains(fen_castling, 'K')) {
       state.castling_rights |= util::toul(CastlingRights::WhiteKingSide);
     }
@@ -181,10 +186,10 @@ std::optional<std::pair<Board,BoardState>>
 
 /*******************************************************************************
  *
- * Method: getPseudoLegalMoves(uint8_t square)
+ * Method: getLegalMoves(uint8_t square)
  *
  *******************************************************************************/
-std::vector<uint8_t> BoardManager::getPseudoLegalMoves(uint8_t square) const
+std::vector<uint8_t> BoardManager::getLegalMoves(uint8_t square) const
 {
   std::vector<uint8_t> ret;
   ret.reserve(55);
@@ -224,32 +229,35 @@ std::tuple<MoveResult, HashedMove> BoardManager::tryMove(const chess::Move& prop
                            proposed.to,
                            util::toul(proposed.promoted_to)))
   {
-    if (result = makeMove(move.value());
-        result != MoveResult::Illegal)
-    {
-      move_made = move.value();
-
-      bool no_legal_moves = true;
-      bool was_check = isCheck(_board, _state);
+    // only legal moves are in the move list
+    makeMove(move.value());
+    result = MoveResult::Valid;
+    move_made = move.value();
+
+    // keep enough room on the undo stack for a search
+    // to be run from this position
+    if (_ply > MaxHistory / 2) {
+      std::copy(_history.begin() + MaxHistory / 4,
+                _history.begin() + _ply,
+                _history.begin());
+      _ply -= MaxHistory / 4;
+    }
 
-      if (was_check) {
-        result = MoveResult::Check;
-      }
+    _move_list.clear();
+    _generator->generateMoves(_board, _state, _move_list);
 
-      // now check if there are no legal moves
-      for (auto m : _move_list) {
-        BoardManager temp = *this;
+    bool was_check = isCheck(_board, _state);
 
-        if (temp.makeMove(m) != MoveResult::Illegal) {
-          no_legal_moves = false;
-          break;
-        }
-      }
+    if (was_check) {
+      result = MoveResult::Check;
+    }
 
-      if (no_legal_moves) {
-        result = was_check ? MoveResult::Checkmate
-                           : MoveResult::Stalemate;
-      }
+    if (_move_list.empty()) {
+      result = was_check ? MoveResult::Checkmate
+                         : MoveResult::Stalemate;
+    }
+    else if (isFiftyMoveDraw() || isRepetition(2)) {
+      result = MoveResult::Draw;
     }
   }
 
@@ -258,18 +266,12 @@ std::tuple<MoveResult, HashedMove> BoardManager::tryMove(const chess::Move& prop
 
 /*******************************************************************************
  *
- * Method: make_move(uint32_t move)
+ * Method: makeMove(const HashedMove&)
  *
  *******************************************************************************/
-MoveResult BoardManager::makeMove(
-    const HashedMove& move)
+void BoardManager::makeMove(const HashedMove& move)
 {
   using namespace util;
-  MoveResult result = MoveResult::Illegal;
-
-  // copy the board and state in case of illegal move
-  Board board_copy = _board;
-  BoardState state_copy = _state;
 
   // parse the move
   const auto&& [ source_square, target_square,
@@ -277,155 +279,155 @@ MoveResult BoardManager::makeMove(
                  capture, double_push,
                  was_en_passant, castling ] = move.explode();
 
-  // do the move on the pieces bitboard
-  move_bit(source_square, target_square, board_copy[piece]);
+  const Color side = _state.side_to_move;
+
+  Undo& undo = _history[_ply++];
+  undo.move = move;
+  undo.castling_rights = _state.castling_rights;
+  undo.en_passant_target = _state.en_passant_target;
+  undo.half_move_clock = _state.half_move_clock;
+  undo.key = _hash;
 
   // if the move was a capture move, remove the captured piece
-  if (capture) {
+  if (capture && !was_en_passant) {
+    const Piece p = move.captured();
 
-    const auto& pieces =
-          (state_copy.side_to_move == White) ? chess::BlackPieces
-                                             : chess::WhitePieces;
-    for (auto p : pieces)
-    {
-      if (is_set(target_square, board_copy[p])) {
-        clear_bit(target_square, board_copy[p]);
-        if (p == BlackRook) {
-          if (target_square == H8) {
-            state_copy.castling_rights &= ~toul(CastlingRights::BlackKingSide);
-          }
-          if (target_square == A8) {
-            state_copy.castling_rights &= ~toul(CastlingRights::BlackQueenSide);
-          }
-        }
-        if (p == WhiteRook) {
-          if (target_square == H1) {
-            state_copy.castling_rights &= ~toul(CastlingRights::WhiteKingSide);
-          }
-          if (target_square == A1) {
-            state_copy.castling_rights &= ~toul(CastlingRights::WhiteQueenSide);
-          }
-        }
-        break;
+    removePiece(p, target_square);
+    _hash ^= zobrist::piece(p, target_square);
+
+    if (p == BlackRook) {
+      if (target_square == H8) {
+        _state.castling_rights &= ~toul(CastlingRights::BlackKingSide);
+      }
+      if (target_square == A8) {
+        _state.castling_rights &= ~toul(CastlingRights::BlackQueenSide);
+      }
+    }
+    if (p == WhiteRook) {
+      if (target_square == H1) {
+        _state.castling_rights &= ~toul(CastlingRights::WhiteKingSide);
+      }
+      if (target_square == A1) {
+        _state.castling_rights &= ~toul(CastlingRights::WhiteQueenSide);
       }
     }
   }
 
+  // do the move on the pieces bitboard
+  movePiece(piece, source_square, target_square);
+  _hash ^= zobrist::piece(piece, source_square) ^ zobrist::piece(piece, target_square);
+
   if (was_en_passant) {
-    switch (state_copy.side_to_move) {
+    switch (side) {
       // if white made an en passant capture
       case White:
       {
-        clear_bit(target_square - 8, board_copy[BlackPawn]);
+        removePiece(BlackPawn, target_square - 8);
+        _hash ^= zobrist::piece(BlackPawn, target_square - 8);
         break;
       }
       // if black made an en passant capture
       case Black:
       {
-        clear_bit(target_square + 8, board_copy[WhitePawn]);
+        removePiece(WhitePawn, target_square + 8);
+        _hash ^= zobrist::piece(WhitePawn, target_square + 8);
         break;
       }
     }
-  } else {
-    state_copy.en_passant_target = chess::NoSquare;
   }
 
+  _state.en_passant_target = chess::NoSquare;
+
   if (double_push) {
-    switch (state_copy.side_to_move) {
+    switch (side) {
       case White:
       {
-        state_copy.en_passant_target = target_square - 8;
+        _state.en_passant_target = target_square - 8;
         break;
       }
       case Black:
       {
-        state_copy.en_passant_target = target_square + 8;
+        _state.en_passant_target = target_square + 8;
         break;
       }
     }
   }
   else if (static_cast<uint8_t>(promoted_to))
   {
-    switch (state_copy.side_to_move) {
-      case White:
-      {
-        clear_bit(target_square, board_copy[WhitePawn]);
-        set_bit(target_square, board_copy[promoted_to]);
-        break;
-      }
-      case Black:
-      {
-        clear_bit(target_square, board_copy[BlackPawn]);
-        set_bit(target_square, board_copy[promoted_to]);
-        break;
-      }
-    }
+    const Piece pawn = (side == White) ? WhitePawn : BlackPawn;
+    removePiece(pawn, target_square);
+    putPiece(promoted_to, target_square);
+    _hash ^= zobrist::piece(pawn, target_square) ^ zobrist::piece(promoted_to, target_square);
   }
   else if (castling) {
     switch (target_square) {
       case chess::G1:
       {
-        move_bit(chess::H1, chess::F1, board_copy[WhiteRook]);
-        state_copy.castling_rights &= ~toul(CastlingRights::WhiteCastlingRights);
+        movePiece(WhiteRook, chess::H1, chess::F1);
+        _hash ^= zobrist::piece(WhiteRook, chess::H1) ^ zobrist::piece(WhiteRook, chess::F1);
+        _state.castling_rights &= ~toul(CastlingRights::WhiteCastlingRights);
         break;
       }
       case chess::C1:
       {
-        move_bit(chess::A1, chess::D1, board_copy[WhiteRook]);
-        state_copy.castling_rights &= ~toul(CastlingRights::WhiteCastlingRights);
+        movePiece(WhiteRook, chess::A1, chess::D1);
+        _hash ^= zobrist::piece(WhiteRook, chess::A1) ^ zobrist::piece(WhiteRook, chess::D1);
+        _state.castling_rights &= ~toul(CastlingRights::WhiteCastlingRights);
         break;
       }
       case chess::G8:
       {
-        move_bit(chess::H8, chess::F8, board_copy[BlackRook]);
-        state_copy.castling_rights &= ~toul(CastlingRights::BlackCastlingRights);
+        movePiece(BlackRook, chess::H8, chess::F8);
+        _hash ^= zobrist::piece(BlackRook, chess::H8) ^ zobrist::piece(BlackRook, chess::F8);
+        _state.castling_rights &= ~toul(CastlingRights::BlackCastlingRights);
         break;
       }
       case chess::C8:
       {
-        move_bit(chess::A8, chess::D8, board_copy[BlackRook]);
-        state_copy.castling_rights &= ~toul(CastlingRights::BlackCastlingRights);
+        movePiece(BlackRook, chess::A8, chess::D8);
+        _hash ^= zobrist::piece(BlackRook, chess::A8) ^ zobrist::piece(BlackRook, chess::D8);
+        _state.castling_rights &= ~toul(CastlingRights::BlackCastlingRights);
         break;
       }
       default:
         break;
     }
   }
-  else if ((state_copy.castling_rights & toul(CastlingRights::WhiteCastlingRights)) ||
-           (state_copy.castling_rights & toul(CastlingRights::BlackCastlingRights)))
+  else if ((_state.castling_rights & toul(CastlingRights::WhiteCastlingRights)) ||
+           (_state.castling_rights & toul(CastlingRights::BlackCastlingRights)))
   {
     switch (piece) {
       case WhiteKing:
       {
-        state_copy.castling_rights &= ~toul(CastlingRights::WhiteCastlingRights);
+        _state.castling_rights &= ~toul(CastlingRights::WhiteCastlingRights);
         break;
       }
       case WhiteRook:
       {
         if (source_square == H1)
         {
-          state_copy.castling_rights &= ~toul(CastlingRights::WhiteKingSide);
+          _state.castling_rights &= ~toul(CastlingRights::WhiteKingSide);
         }
         else if (source_square == A1)
         {
-          state_copy.castling_rights &= ~toul(CastlingRights::WhiteQueenSide);
+          _state.castling_rights &= ~toul(CastlingRights::WhiteQueenSide);
         }
         break;
       }
       case BlackKing:
       {
-        state_copy.castling_rights &= ~toul(CastlingRights::BlackCastlingRights);
+        _state.castling_rights &= ~toul(CastlingRights::BlackCastlingRights);
         break;
       }
       case BlackRook:
       {
         if (source_square == A8)
         {
-          state_copy.castling_rights &= ~toul(CastlingRights::BlackQueenSide);
+          _state.castling_rights &= ~toul(CastlingRights::BlackQueenSide);
         }
         if (source_square == H8)
         {
-          state_copy.castling_rights &= ~toul(CastlingRights::BlackKingSide);
+          _state.castling_rights &= ~toul(CastlingRights::BlackKingSide);
         }
         break;
       }
@@ -435,44 +437,195 @@ MoveResult BoardManager::makeMove(
   }
 
   // update occupancies
-  updateOccupancies(board_copy);
+  updateOccupancies(_board);
+
+  _state.side_to_move = (side == White) ? Black : White;
 
-  // if the move puts themselves in check -> Illegal
-  if (isCheck(board_copy, state_copy)) {
-    return MoveResult::Illegal;
+  // successful move from black means full move cnt++
+  if (_state.side_to_move == White) {
+    _state.full_move_count++;
   }
-  else 
+
+  // the half move clock is the number of
+  // half moves since the last pawn move or any capture
+  if (!capture && piece != WhitePawn && piece != BlackPawn)
   {
-    result = MoveResult::Valid;
-    state_copy.side_to_move = (state_copy.side_to_move == White) ? Black
-                                                                 : White;
+    _state.half_move_clock++;
+  }
+  else
+  {
+    _state.half_move_clock = 0;
+  }
+
+  _hash ^= zobrist::castling(undo.castling_rights) ^ zobrist::castling(_state.castling_rights);
+  _hash ^= zobrist::en_passant(undo.en_passant_target) ^ zobrist::en_passant(_state.en_passant_target);
+  _hash ^= zobrist::side();
+}
+
+/*******************************************************************************
+ *
+ * Method: unmakeMove()
+ *
+ *******************************************************************************/
+void BoardManager::unmakeMove()
+{
+  const Undo& undo = _history[--_ply];
+
+  const auto&& [ source_square, target_square,
+                 piece, promoted_to,
+                 capture, double_push,
+                 was_en_passant, castling ] = undo.move.explode();
 
-    // successful move from black means full move cnt++
-    if (state_copy.side_to_move == White) {
-      state_copy.full_move_count++;
+  const Color side = (_state.side_to_move == White) ? Black : White;
+
+  _state.side_to_move = side;
+  if (side == Black) {
+    _state.full_move_count--;
+  }
+
+  _state.castling_rights = undo.castling_rights;
+  _state.en_passant_target = undo.en_passant_target;
+  _state.half_move_clock = undo.half_move_clock;
+  _hash = undo.key;
+
+  // put the moving piece back
+  if (static_cast<uint8_t>(promoted_to)) {
+    removePiece(promoted_to, target_square);
+    putPiece(piece, source_square);
+  } else {
+    movePiece(piece, target_square, source_square);
+  }
+
+  // restore whatever was captured
+  if (capture) {
+    if (was_en_passant) {
+      putPiece(undo.move.captured(),
+               side == White ? target_square - 8 : target_square + 8);
+    } else {
+      putPiece(undo.move.captured(), target_square);
     }
+  }
 
-    // the half move clock is the number of
-    // half moves since the last pawn move or any capture
-    if (!capture &&  piece != WhitePawn && piece != BlackPawn)
-    {
-      state_copy.half_move_clock++;
+  // put the rook back
+  if (castling) {
+    switch (target_square) {
+      case chess::G1:
+        movePiece(WhiteRook, chess::F1, chess::H1);
+        break;
+      case chess::C1:
+        movePiece(WhiteRook, chess::D1, chess::A1);
+        break;
+      case chess::G8:
+        movePiece(BlackRook, chess::F8, chess::H8);
+        break;
+      case chess::C8:
+        movePiece(BlackRook, chess::D8, chess::A8);
+        break;
+      default:
+        break;
     }
+  }
 
-    _board = board_copy;
-    _state = state_copy;
+  updateOccupancies(_board);
+}
 
-    // TODO: PEM do zobrist hashing instead
-    // because this is incredibly slow
-    if (!NO_HISTORY) {
-      _history.push_back(generateFen());
+/*******************************************************************************
+ *
+ * Method: makeNullMove()
+ *
+ *******************************************************************************/
+void BoardManager::makeNullMove()
+{
+  Undo& undo = _history[_ply++];
+  undo.move.hashed = 0;
+  undo.castling_rights = _state.castling_rights;
+  undo.en_passant_target = _state.en_passant_target;
+  undo.half_move_clock = _state.half_move_clock;
+  undo.key = _hash;
+
+  // the pawn that could have been taken en passant is safe now
+  _hash ^= zobrist::en_passant(_state.en_passant_target);
+  _state.en_passant_target = chess::NoSquare;
+
+  _state.side_to_move = (_state.side_to_move == White) ? Black : White;
+  _state.half_move_clock++;
+  _hash ^= zobrist::side();
+}
+
+/*******************************************************************************
+ *
+ * Method: unmakeNullMove()
+ *
+ *******************************************************************************/
+void BoardManager::unmakeNullMove()
+{
+  const Undo& undo = _history[--_ply];
+
+  _state.side_to_move = (_state.side_to_move == White) ? Black : White;
+  _state.en_passant_target = undo.en_passant_target;
+  _state.half_move_clock = undo.half_move_clock;
+  _hash = undo.key;
+}
+
+/*******************************************************************************
+ *
+ * Method: isRepetition(int count)
+ *
+ *******************************************************************************/
+bool BoardManager::isRepetition(int count) const
+{
+  // captures and pawn moves can't be taken back, so only positions
+  // since the last one can come back. neither can positions from
+  // before a null move
+  const size_t reversible = std::min<size_t>(_state.half_move_clock, _ply);
+  int found = 0;
+
+  for (size_t back = 1; back <= reversible; back++) {
+    const Undo& undo = _history[_ply - back];
+
+    if (undo.move.hashed == 0) {
+      break;
     }
 
-    _move_list.clear();
-    _generator->generateMoves(_board, _state, _move_list);
+    // the same side is to move every other ply
+    if (back % 2 == 0 && undo.key == _hash && ++found >= count) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+/*******************************************************************************
+ *
+ * Method: unpack(PackedMove)
+ *
+ *******************************************************************************/
+HashedMove BoardManager::unpack(PackedMove packed) const
+{
+  const uint8_t source = packed.source();
+  const uint8_t target = packed.target();
+  const Piece piece = _mailbox[source];
+  const bool is_pawn = piece == WhitePawn || piece == BlackPawn;
+
+  HashedMove move;
+  move.hashed = 0;
+  move.m.source = source;
+  move.m.target = target;
+  move.m.piece = piece;
+  move.m.promoted = packed.promoted(_state.side_to_move);
+  move.m.double_push = is_pawn && (source > target ? source - target : target - source) == 16;
+  move.m.enpassant = packed.kind() == PackedMove::EnPassant;
+  move.m.castling = packed.kind() == PackedMove::Castling;
+
+  if (move.m.enpassant) {
+    move.m.captured = (_state.side_to_move == White) ? BlackPawn : WhitePawn;
+  } else {
+    move.m.captured = _mailbox[target];
   }
+  move.m.capture = move.m.captured != NoPiece;
 
-  return result;
+  return move;
 }
 
 /*******************************************************************************
@@ -119,6 +119,23 @@ std::string to_string(const HashedMove& m) {
   return str;
 }
 
+/*******************************************************************************
+ *
+ * Function: chess::to_uci_string(const HashedMove& m)
+ *
+ *******************************************************************************/
+std::string to_uci_string(const HashedMove& m)
+{
+  auto str = *fen::index_to_algebraic(m.m.source) +
+             *fen::index_to_algebraic(m.m.target);
+
+  if (m.m.promoted) {
+    str += std::tolower(fen::piece_to_char(static_cast<Piece>(m.m.promoted)));
+  }
+
+  return str;
+}
+
 /*******************************************************************************
  *
  * Function: chess::to_string(Color c)
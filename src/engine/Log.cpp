@@ -0,0 +1,40 @@
+#include "engine/Log.hxx"
+
+#include <iostream>
+#include <mutex>
+
+namespace chess::log {
+
+namespace {
+  std::mutex sink_mutex;
+
+  Sink current_sink = [](const std::string& message) {
+    std::cerr << message << std::endl;
+  };
+}
+
+/*******************************************************************************
+ *
+ * Function: log::set_sink(Sink)
+ *
+ *******************************************************************************/
+void set_sink(Sink sink)
+{
+  std::lock_guard lock(sink_mutex);
+  current_sink = std::move(sink);
+}
+
+/*******************************************************************************
+ *
+ * Function: log::write(const std::string&)
+ *
+ *******************************************************************************/
+void write(const std::string& message)
+{
+  std::lock_guard lock(sink_mutex);
+  if (current_sink) {
+    current_sink(message);
+  }
+}
+
+} // namespace chess::log
@@ -2,42 +2,28 @@
 
 namespace chess {
 
-/*******************************************************************************
- *
- * Method: MoveGenerator()
- *
- *******************************************************************************/
-MoveGenerator::MoveGenerator()
-  : pawn_attacks(initPawnAttacks())
-  , knight_attacks(initKnightAttacks())
-  , king_attacks(initKingAttacks())
-  , bishop_masks(initBishopMasks())
-  , rook_masks(initRookMasks())
-  , bishop_attacks(initSliderAttacks<512, true>(bishop_masks, bishop_magics, bishop_bits))
-  , rook_attacks(initSliderAttacks<4096, false>(rook_masks, rook_magics, rook_bits))
-{
-}
-
 /*******************************************************************************
  *
  * Method: addMove()
  *
  *******************************************************************************/
-inline void MoveGenerator::addMove(std::vector<HashedMove>& moves,
+inline void MoveGenerator::addMove(MoveList& moves,
                                    uint32_t source, uint32_t target,
                                    uint32_t piece, uint32_t promotion,
-                                   uint32_t capture, uint32_t double_push,
+                                   uint32_t captured, uint32_t double_push,
                                    uint32_t enpassant, uint32_t castling) const
 {
   HashedMove move;
+  move.hashed = 0;
   move.m.source = source;
   move.m.target = target;
   move.m.piece = piece;
   move.m.promoted = promotion;
-  move.m.capture = capture;
+  move.m.capture = captured != NoPiece;
   move.m.double_push = double_push;
   move.m.enpassant = enpassant;
   move.m.castling = castling;
+  move.m.captured = captured;
 
   moves.push_back(move);
 }
@@ -49,286 +35,304 @@ inline void MoveGenerator::addMove(std::vector<HashedMove>& moves,
  *******************************************************************************/
 void MoveGenerator::generateMoves(const Board& b,
                                   const BoardState& s,
-                                  std::vector<HashedMove>& moves) const
+                                  MoveList& moves) const
 {
-  switch (s.side_to_move) {
-    case White:
-    {
-      generateWhitePawnMoves(b, s, moves);
-      generateCastlingMoves<White>(b, s, moves);
-      generateKnightMoves<White>(b, moves);
-      generateBishopMoves<White>(b, moves);
-      generateRookMoves<White>(b, moves);
-      generateQueenMoves<White>(b, moves);
-      generateKingMoves<White>(b, moves);
-      break;
-    }
-    case Black:
-    {
-      generateBlackPawnMoves(b, s, moves);
-      generateCastlingMoves<Black>(b, s, moves);
-      generateKnightMoves<Black>(b, moves);
-      generateBishopMoves<Black>(b, moves);
-      generateRookMoves<Black>(b, moves);
-      generateQueenMoves<Black>(b, moves);
-      generateKingMoves<Black>(b, moves);
-      break;
-    }
-  }
-
+  generate(b, s, GenType::All, moves);
 }
 
 /*******************************************************************************
  *
- * Method: initPawnAttacks()
+ * Method: generateCaptures(Board&, BoardState&, HashedMove& moves)
  *
  *******************************************************************************/
-std::vector<std::vector<Bitboard>> MoveGenerator::initPawnAttacks()
+void MoveGenerator::generateCaptures(const Board& b,
+                                     const BoardState& s,
+                                     MoveList& moves) const
 {
-  std::vector<std::vector<Bitboard>> result(2, std::vector<Bitboard>(64));
-
-  constexpr auto get_mask = []<Color C>(uint8_t square) {
-    Bitboard attacks {0ULL};
-    Bitboard b {0ULL};
-
-    set_bit(square, b);
-
-    if constexpr (C == White) {
-      if ((b << 7) & not_h_file)
-        attacks |= (b << 7);
-
-      if ((b << 9) & not_a_file)
-        attacks |= (b << 9);
-
-    }
-    else {
-      if ((b >> 7) & not_a_file)
-        attacks |= (b >> 7);
-
-      if ((b >> 9) & not_h_file)
-        attacks |= (b >> 9);
-    }
-
-    return attacks;
-  };
-
-  for (const auto i : util::range(NoSquare)) {
-    result[White][i] = get_mask.template operator()<White>(i);
-    result[Black][i] = get_mask.template operator()<Black>(i);
-  }
-
-  return result;
+  generate(b, s, GenType::Captures, moves);
 }
 
 /*******************************************************************************
  *
- * Method: initKnightAttacks()
+ * Method: generateQuiets(Board&, BoardState&, HashedMove& moves)
  *
  *******************************************************************************/
-std::vector<Bitboard> MoveGenerator::initKnightAttacks()
+void MoveGenerator::generateQuiets(const Board& b,
+                                   const BoardState& s,
+                                   MoveList& moves) const
 {
-  std::vector<Bitboard> result(64);
-
-  for (auto square : util::range(NoSquare)) {
-    Bitboard attacks {0ULL};
-    Bitboard b {0ULL};
-
-    set_bit(square, b);
-
-    if ((b << 17) & not_a_file)
-      attacks |= b << 17;
-    if ((b << 15) & not_h_file)
-      attacks |= b << 15;
-    if ((b << 10) & not_ab_file)
-      attacks |= b << 10;
-    if ((b << 6) & not_hg_file)
-      attacks |= b << 6;
-    if ((b >> 17) & not_h_file)
-      attacks |= b >> 17;
-    if ((b >> 15) & not_a_file)
-      attacks |= b >> 15;
-    if ((b >> 10) & not_hg_file)
-      attacks |= b >> 10;
-    if ((b >> 6) & not_ab_file)
-      attacks |= b >> 6;
-
-    result[square] = attacks;
-  }
-  return result;
+  generate(b, s, GenType::Quiets, moves);
 }
 
 /*******************************************************************************
  *
- * Method: initKingAttacks()
+ * Method: generate(Board&, BoardState&, GenType, HashedMove& moves)
  *
  *******************************************************************************/
-std::vector<Bitboard> MoveGenerator::initKingAttacks()
+void MoveGenerator::generate(const Board& b,
+                             const BoardState& s,
+                             GenType type,
+                             MoveList& moves) const
 {
-  std::vector<Bitboard> result(64);
-
-  for (const auto square : util::range(NoSquare)) {
-    Bitboard attacks {0ULL};
-    Bitboard b {0ULL};
-
-    set_bit(square, b);
-
-    if ((b << 8))
-      attacks |= b << 8;
-    if ((b << 9) & not_a_file)
-      attacks |= b << 9;
-    if ((b << 7) & not_h_file)
-      attacks |= b << 7;
-    if ((b << 1) & not_a_file)
-      attacks |= b << 1;
-
-    if ((b >> 8))
-      attacks |= b >> 8;
-    if ((b >> 9) & not_h_file)
-      attacks |= b >> 9;
-    if ((b >> 7) & not_a_file)
-      attacks |= b >> 7;
-    if ((b >> 1) & not_h_file)
-      attacks |= b >> 1;
-
-    result[square] = attacks;
+  switch (s.side_to_move) {
+    case White:
+      generate<White>(b, s, type, moves);
+      break;
+    case Black:
+      generate<Black>(b, s, type, moves);
+      break;
   }
-
-  return result;
 }
 
 /*******************************************************************************
  *
- * Method: initBishopMasks()
+ * Method: generate<side>(Board&, BoardState&, GenType, HashedMove& moves)
  *
  *******************************************************************************/
-std::vector<Bitboard> MoveGenerator::initBishopMasks()
+template<Color side>
+void MoveGenerator::generate(const Board& b,
+                             const BoardState& s,
+                             GenType type,
+                             MoveList& moves) const
 {
-  std::vector<Bitboard> result(64);
+  constexpr Piece opp_color = (side == White) ? BlackAll : WhiteAll;
 
-  for (const auto square : util::range(NoSquare)) {
-    Bitboard attacks {0ULL};
+  auto masks = calcMoveMasks<side>(b);
+  masks.captures = type != GenType::Quiets;
+  masks.quiets = type != GenType::Captures;
 
-    int r = 0;
-    int f = 0;
-    int tr = square / 8;
-    int tf = square % 8;
+  switch (type) {
+    case GenType::All:      masks.targets = ~0ULL;         break;
+    case GenType::Captures: masks.targets = b[opp_color];  break;
+    case GenType::Quiets:   masks.targets = ~b[opp_color]; break;
+  }
 
-    for (r = tr + 1, f = tf + 1; r <= 6 && f <= 6; r++, f++) {
-      set_bit(r * 8 + f, attacks);
-    }
-    for (r = tr - 1, f = tf + 1; r >= 1 && f <= 6; r--, f++) {
-      set_bit(r * 8 + f, attacks);
+  // only the king can get out of a double check
+  if (bits::count(masks.checkers) < 2) {
+    if constexpr (side == White) {
+      generateWhitePawnMoves(b, s, masks, moves);
+    } else {
+      generateBlackPawnMoves(b, s, masks, moves);
     }
-    for (r = tr + 1, f = tf - 1; r <= 6 && f >= 1; r++, f--) {
-      set_bit(r * 8 + f, attacks);
-    }
-    for (r = tr - 1, f = tf - 1; r >= 1 && f >= 1; r--, f--) {
-      set_bit(r * 8 + f, attacks);
+
+    if (masks.quiets) {
+      generateCastlingMoves<side>(b, s, masks, moves);
     }
 
-    result[square] = attacks;
+    generateKnightMoves<side>(b, masks, moves);
+    generateBishopMoves<side>(b, masks, moves);
+    generateRookMoves<side>(b, masks, moves);
+    generateQueenMoves<side>(b, masks, moves);
   }
-
-  return result;
+  generateKingMoves<side>(b, masks, moves);
 }
 
 /*******************************************************************************
  *
- * Method: initRookMasks()
- *
+ * Method: isSquareAttacked(uint8_t square, Color side)
+ * is the given square attacked by the given side
  *******************************************************************************/
-std::vector<Bitboard> MoveGenerator::initRookMasks()
+bool MoveGenerator::isSquareAttacked(uint8_t square,
+                                     Color side,
+                                     const Board& board) const
 {
-  std::vector<Bitboard> result(64);
+  // check if the opposing colors piece can attack it
+  // even if the opposing piece isnt there, this by definition
+  // gives us the desired result
+  if ((side == White) && (tables::pawn_attacks[Black][square] & board[WhitePawn]) ) {
+    return true;
+  }
 
-  for (auto square : util::range(NoSquare)) {
-    Bitboard attacks {0ULL};
+  if ((side == Black) && (tables::pawn_attacks[White][square] & board[BlackPawn]) ) {
+    return true;
+  }
 
-    int r = 0;
-    int f = 0;
-    int tr = square / 8;
-    int tf = square % 8;
+  if (tables::knight_attacks[square] & board[(side == White) ? WhiteKnight : BlackKnight]) {
+    return true;
+  }
 
-    for (r = tr + 1; r <= 6; r++) {
-      set_bit(r * 8 + tf, attacks);
-    }
-    for (r = tr - 1; r >= 1; r--) {
-      set_bit(r * 8 + tf, attacks);
-    }
-    for (f = tf + 1; f <= 6; f++) {
-      set_bit(tr * 8 + f, attacks);
-    }
-    for (f = tf - 1; f >= 1; f--) {
-      set_bit(tr * 8 + f, attacks);
-    }
+  if (getBishopAttacks(square, board[All]) &
+      ( (side == White) ? board[WhiteBishop] : board[BlackBishop] ) )
+  {
+    return true;
+  }
 
-    result[square] = attacks;
+  if (getRookAttacks(square, board[All]) &
+      ( (side == White) ? board[WhiteRook] : board[BlackRook] ) )
+  {
+    return true;
+  }
+
+  if (getQueenAttacks(square, board[All]) &
+      ( (side == White) ? board[WhiteQueen] : board[BlackQueen] ) )
+  {
+    return true;
   }
-  return result;
+
+  if (tables::king_attacks[square] & board[(side == White) ? WhiteKing : BlackKing] )
+  {
+    return true;
+  }
+
+  return false;
 }
 
 /*******************************************************************************
  *
- * Method: calcBishopAttacks(uint8_t square, Bitboard occ)
+ * Method: attackersTo(const Board&, uint8_t square, Bitboard occupancy)
  *
  *******************************************************************************/
-Bitboard MoveGenerator::calcBishopAttacks(uint8_t square, Bitboard occ) const
+Bitboard MoveGenerator::attackersTo(const Board& b,
+                                    uint8_t square,
+                                    Bitboard occupancy) const
 {
-  Bitboard attacks {0ULL};
+  // a pawn of one color attacks square if a pawn of the other
+  // color on square would attack it
+  return (tables::pawn_attacks[Black][square] & b[WhitePawn]) |
+         (tables::pawn_attacks[White][square] & b[BlackPawn]) |
+         (tables::knight_attacks[square] & (b[WhiteKnight] | b[BlackKnight])) |
+         (tables::king_attacks[square] & (b[WhiteKing] | b[BlackKing])) |
+         (getBishopAttacks(square, occupancy) &
+          (b[WhiteBishop] | b[BlackBishop] | b[WhiteQueen] | b[BlackQueen])) |
+         (getRookAttacks(square, occupancy) &
+          (b[WhiteRook] | b[BlackRook] | b[WhiteQueen] | b[BlackQueen]));
+}
+
+/*******************************************************************************
+ *
+ * Method: see(const Board&, const HashedMove&)
+ * material won or lost by the side moving if both sides keep recapturing
+ * on the target square with their least valuable piece, either side can
+ * stop when going on would lose more. pins are not considered
+ *******************************************************************************/
+int MoveGenerator::see(const Board& b, const HashedMove& move) const
+{
+  const uint8_t source = move.m.source;
+  const uint8_t target = move.m.target;
+  const Color us = eval::color_of(static_cast<Piece>(move.m.piece));
 
-  int r, f;
-  int tr = square / 8;
-  int tf = square % 8;
+  // gain[d] is what the side making capture d wins if the exchange
+  // stops right after it
+  std::array<int, 32> gain {};
+  int d = 0;
 
-  for (r = tr + 1, f = tf + 1; r <= 7 && f <= 7; r++, f++) {
-    set_bit(r * 8 + f, attacks);
-    if (is_set(r * 8 + f, occ)) break;
+  Bitboard occupancy = b[All];
+  clear_bit(source, occupancy);
+
+  // the piece that will stand on target and can be taken next
+  Piece on_target = static_cast<Piece>(move.m.piece);
+  gain[0] = eval::piece_values[move.m.captured];
+
+  if (move.m.promoted) {
+    on_target = static_cast<Piece>(move.m.promoted);
+    gain[0] += eval::piece_values[on_target] - eval::piece_values[move.m.piece];
   }
-  for (r = tr - 1, f = tf + 1; r >= 0 && f <= 7; r--, f++) {
-    set_bit(r * 8 + f, attacks);
-    if (is_set(r * 8 + f, occ)) break;
+
+  if (move.m.enpassant) {
+    clear_bit(us == White ? target - 8 : target + 8, occupancy);
   }
-  for (r = tr + 1, f = tf - 1; r <= 7 && f >= 0; r++, f--) {
-    set_bit(r * 8 + f, attacks);
-    if (is_set(r * 8 + f, occ)) break;
+
+  const Bitboard diagonal = b[WhiteBishop] | b[BlackBishop] | b[WhiteQueen] | b[BlackQueen];
+  const Bitboard straight = b[WhiteRook] | b[BlackRook] | b[WhiteQueen] | b[BlackQueen];
+
+  Bitboard attackers = attackersTo(b, target, occupancy) & occupancy;
+  Color side = (us == White) ? Black : White;
+
+  while (true) {
+    const auto& pieces = (side == White) ? WhitePieces : BlackPieces;
+    const Bitboard own = attackers & b[side == White ? WhiteAll : BlackAll];
+
+    if (!own) {
+      break;
+    }
+
+    // least valuable attacker, the arrays are ordered pawn to king
+    Piece attacker = NoPiece;
+    Bitboard from = 0ULL;
+    for (auto p : pieces) {
+      if (own & b[p]) {
+        attacker = p;
+        from = own & b[p];
+        break;
+      }
+    }
+
+    occupancy &= ~(from & -from);
+
+    // taking it away may uncover a slider behind it
+    attackers |= (getBishopAttacks(target, occupancy) & diagonal) |
+                 (getRookAttacks(target, occupancy) & straight);
+    attackers &= occupancy;
+
+    // the king may only recapture if nothing can take it back
+    const Bitboard theirs = attackers & b[side == White ? BlackAll : WhiteAll];
+    if ((attacker == WhiteKing || attacker == BlackKing) && theirs) {
+      break;
+    }
+
+    d++;
+    gain[d] = eval::piece_values[on_target] - gain[d - 1];
+    on_target = attacker;
+    side = (side == White) ? Black : White;
   }
-  for (r = tr - 1, f = tf - 1; r >= 0 && f >= 0; r--, f--) {
-    set_bit(r * 8 + f, attacks);
-    if (is_set(r * 8 + f, occ)) break;
+
+  // each side picks the better of stopping or going on
+  while (d > 0) {
+    gain[d - 1] = -std::max(-gain[d - 1], gain[d]);
+    d--;
   }
 
-  return attacks;
+  return gain[0];
 }
 
 /*******************************************************************************
  *
- * Method: calcRookAttacks(uint8_t square, Bitboard occ)
+ * Method: calcAttacks(const Board&, Bitboard occupancy)
  *
  *******************************************************************************/
-Bitboard MoveGenerator::calcRookAttacks(uint8_t square, Bitboard occ) const
+template<Color side>
+Bitboard MoveGenerator::calcAttacks(const Board& b, Bitboard occupancy) const
 {
+  constexpr Piece pawn = (side == White) ? WhitePawn : BlackPawn;
+  constexpr Piece knight = (side == White) ? WhiteKnight : BlackKnight;
+  constexpr Piece bishop = (side == White) ? WhiteBishop : BlackBishop;
+  constexpr Piece rook = (side == White) ? WhiteRook : BlackRook;
+  constexpr Piece queen = (side == White) ? WhiteQueen : BlackQueen;
+  constexpr Piece king = (side == White) ? WhiteKing : BlackKing;
+
   Bitboard attacks {0ULL};
 
-  int r = 0;
-  int f = 0;
-  int tr = square / 8;
-  int tf = square % 8;
+  // all pawns at once
+  if constexpr (side == White) {
+    attacks |= ((b[pawn] << 7) & not_h_file) | ((b[pawn] << 9) & not_a_file);
+  }
+  else {
+    attacks |= ((b[pawn] >> 7) & not_a_file) | ((b[pawn] >> 9) & not_h_file);
+  }
 
-  for (r = tr + 1; r <= 7; r++) {
-    set_bit(r * 8 + tf, attacks);
-    if (is_set(r * 8 + tf, occ)) break;
+  Bitboard pieces = b[knight];
+  while (pieces) {
+    uint8_t square = bits::get_lsb_index(pieces);
+    attacks |= tables::knight_attacks[square];
+    clear_bit(square, pieces);
   }
-  for (r = tr - 1; r >= 0; r--) {
-    set_bit(r * 8 + tf, attacks);
-    if (is_set(r * 8 + tf, occ)) break;
+
+  pieces = b[bishop] | b[queen];
+  while (pieces) {
+    uint8_t square = bits::get_lsb_index(pieces);
+    attacks |= getBishopAttacks(square, occupancy);
+    clear_bit(square, pieces);
   }
-  for (f = tf + 1; f <= 7; f++) {
-    set_bit(tr * 8 + f, attacks);
-    if (is_set(tr * 8 + f, occ)) break;
+
+  pieces = b[rook] | b[queen];
+  while (pieces) {
+    uint8_t square = bits::get_lsb_index(pieces);
+    attacks |= getRookAttacks(square, occupancy);
+    clear_bit(square, pieces);
   }
-  for (f = tf - 1; f >= 0; f--) {
-    set_bit(tr * 8 + f, attacks);
-    if (is_set(tr * 8 + f, occ)) break;
+
+  if (b[king]) {
+    attacks |= tables::king_attacks[bits::get_lsb_index(b[king])];
   }
 
   return attacks;
@@ -336,78 +340,102 @@ Bitboard MoveGenerator::calcRookAttacks(uint8_t square, Bitboard occ) const
 
 /*******************************************************************************
  *
- * Method: getBishopAttacks(uint8_t square, Bitboard occ)
+ * Method: calcMoveMasks(const Board&)
  *
  *******************************************************************************/
-Bitboard MoveGenerator::getBishopAttacks(uint8_t square, Bitboard occupancy) const
+template<Color side>
+MoveGenerator::MoveMasks MoveGenerator::calcMoveMasks(const Board& b) const
 {
-  occupancy &= bishop_masks[square];
-  uint16_t index =
-    (occupancy * bishop_magics[square]) >> (64ULL - bishop_bits[square]);
-  return bishop_attacks[square][index];
-}
+  constexpr Color enemy = (side == White) ? Black : White;
+  constexpr Piece own_color = (side == White) ? WhiteAll : BlackAll;
+  constexpr Piece king_t = (side == White) ? WhiteKing : BlackKing;
+  constexpr Piece enemy_pawn = (side == White) ? BlackPawn : WhitePawn;
+  constexpr Piece enemy_knight = (side == White) ? BlackKnight : WhiteKnight;
+  constexpr Piece enemy_bishop = (side == White) ? BlackBishop : WhiteBishop;
+  constexpr Piece enemy_rook = (side == White) ? BlackRook : WhiteRook;
+  constexpr Piece enemy_queen = (side == White) ? BlackQueen : WhiteQueen;
+
+  MoveMasks masks;
+  masks.king = bits::get_lsb_index(b[king_t]);
+
+  const Bitboard diagonal = b[enemy_bishop] | b[enemy_queen];
+  const Bitboard straight = b[enemy_rook] | b[enemy_queen];
+
+  masks.checkers = (tables::pawn_attacks[side][masks.king] & b[enemy_pawn]) |
+                   (tables::knight_attacks[masks.king] & b[enemy_knight]) |
+                   (getBishopAttacks(masks.king, b[All]) & diagonal) |
+                   (getRookAttacks(masks.king, b[All]) & straight);
+
+  switch (bits::count(masks.checkers)) {
+    case 0:
+      masks.evasions = ~0ULL;
+      break;
 
-/*******************************************************************************
- *
- * Method: getRookAttacks(uint8_t square, Bitboard occ)
- *
- *******************************************************************************/
-Bitboard MoveGenerator::getRookAttacks(uint8_t square, Bitboard occupancy) const
-{
-  occupancy &= rook_masks[square];
-  uint16_t index =
-    (occupancy * rook_magics[square]) >> (64ULL - rook_bits[square]);
-  return rook_attacks[square][index];
-}
+    case 1:
+      masks.evasions = masks.checkers |
+        tables::between[masks.king][bits::get_lsb_index(masks.checkers)];
+      break;
 
-/*******************************************************************************
- *
- * Method: isSquareAttacked(uint8_t square, Color side)
- * is the given square attacked by the given side
- *******************************************************************************/
-bool MoveGenerator::isSquareAttacked(uint8_t square,
-                                     Color side,
-                                     const Board& board) const
-{
-  // check if the opposing colors piece can attack it
-  // even if the opposing piece isnt there, this by definition
-  // gives us the desired result
-  if ((side == White) && (pawn_attacks[Black][square] & board[WhitePawn]) ) {
-    return true;
+    default:
+      masks.evasions = 0ULL;
+      break;
   }
 
-  if ((side == Black) && (pawn_attacks[White][square] & board[BlackPawn]) ) {
-    return true;
-  }
+  // sliders that would see the king through exactly one of our pieces
+  masks.pinned = 0ULL;
+  Bitboard snipers = (getBishopAttacks(masks.king, 0ULL) & diagonal) |
+                     (getRookAttacks(masks.king, 0ULL) & straight);
 
-  if (knight_attacks[square] & board[(side == White) ? WhiteKnight : BlackKnight]) {
-    return true;
-  }
+  while (snipers) {
+    uint8_t square = bits::get_lsb_index(snipers);
+    Bitboard blockers = tables::between[masks.king][square] & b[All];
 
-  if (getBishopAttacks(square, board[All]) &
-      ( (side == White) ? board[WhiteBishop] : board[BlackBishop] ) )
-  {
-    return true;
-  }
+    if (bits::count(blockers) == 1) {
+      masks.pinned |= blockers & b[own_color];
+    }
 
-  if (getRookAttacks(square, board[All]) &
-      ( (side == White) ? board[WhiteRook] : board[BlackRook] ) )
-  {
-    return true;
+    clear_bit(square, snipers);
   }
 
-  if (getQueenAttacks(square, board[All]) &
-      ( (side == White) ? board[WhiteQueen] : board[BlackQueen] ) )
-  {
-    return true;
-  }
+  // the king can't hide behind itself from a slider
+  Bitboard occupancy = b[All];
+  clear_bit(masks.king, occupancy);
+  masks.danger = calcAttacks<enemy>(b, occupancy);
 
-  if (king_attacks[square] & board[(side == White) ? WhiteKing : BlackKing] )
-  {
-    return true;
-  }
+  return masks;
+}
 
-  return false;
+/*******************************************************************************
+ *
+ * Method: isLegalEnPassant(const Board&, uint8_t source, uint8_t target, king)
+ *
+ *******************************************************************************/
+template<Color side>
+bool MoveGenerator::isLegalEnPassant(const Board& b,
+                                     uint8_t source,
+                                     uint8_t target,
+                                     uint8_t king) const
+{
+  constexpr Piece enemy_pawn = (side == White) ? BlackPawn : WhitePawn;
+  constexpr Piece enemy_knight = (side == White) ? BlackKnight : WhiteKnight;
+  constexpr Piece enemy_bishop = (side == White) ? BlackBishop : WhiteBishop;
+  constexpr Piece enemy_rook = (side == White) ? BlackRook : WhiteRook;
+  constexpr Piece enemy_queen = (side == White) ? BlackQueen : WhiteQueen;
+
+  const uint8_t captured = (side == White) ? target - 8 : target + 8;
+
+  Bitboard occupancy = b[All];
+  clear_bit(source, occupancy);
+  clear_bit(captured, occupancy);
+  set_bit(target, occupancy);
+
+  Bitboard pawns = b[enemy_pawn];
+  clear_bit(captured, pawns);
+
+  return !((tables::pawn_attacks[side][king] & pawns) |
+           (tables::knight_attacks[king] & b[enemy_knight]) |
+           (getBishopAttacks(king, occupancy) & (b[enemy_bishop] | b[enemy_queen])) |
+           (getRookAttacks(king, occupancy) & (b[enemy_rook] | b[enemy_queen])));
 }
 
 /*******************************************************************************
@@ -417,7 +445,8 @@ bool MoveGenerator::isSquareAttacked(uint8_t square,
  *******************************************************************************/
 void MoveGenerator::generateWhitePawnMoves(const Board& board_,
                                            const BoardState& state,
-                                           std::vector<HashedMove>& moves) const
+                                           const MoveMasks& masks,
+                                           MoveList& moves) const
 {
   Bitboard board = board_[WhitePawn];
   uint8_t source_square = 0;
@@ -425,6 +454,7 @@ void MoveGenerator::generateWhitePawnMoves(const Board& board_,
 
   while (board) {
     source_square = bits::get_lsb_index(board);
+    const Bitboard allowed = allowedTargets(source_square, masks);
 
     // this is a white pawn push of 1 square
     target_square = source_square + 8;
@@ -434,16 +464,21 @@ void MoveGenerator::generateWhitePawnMoves(const Board& board_,
       // promotion
       if (source_square >= chess::A7 && source_square <= chess::H7) {
 
-        addMove(moves, source_square, target_square, WhitePawn, WhiteQueen, 0,0,0,0);
-        addMove(moves, source_square, target_square, WhitePawn, WhiteRook,  0,0,0,0);
-        addMove(moves, source_square, target_square, WhitePawn, WhiteBishop,0,0,0,0);
-        addMove(moves, source_square, target_square, WhitePawn, WhiteKnight,0,0,0,0);
+        if (masks.captures && is_set(target_square, allowed)) {
+          addMove(moves, source_square, target_square, WhitePawn, WhiteQueen, 0,0,0,0);
+          addMove(moves, source_square, target_square, WhitePawn, WhiteRook,  0,0,0,0);
+          addMove(moves, source_square, target_square, WhitePawn, WhiteBishop,0,0,0,0);
+          addMove(moves, source_square, target_square, WhitePawn, WhiteKnight,0,0,0,0);
+        }
 
-      } else { // one move forward, no promotion
+      } else if (masks.quiets) { // one move forward, no promotion
+        if (is_set(target_square, allowed)) {
           addMove(moves, source_square, target_square, WhitePawn, NoPiece, 0,0,0,0);
+        }
 
         if ((source_square >= chess::A2 && source_square <= chess::H2) &&
-            !is_set(target_square + 8, board_[All]))
+            !is_set(target_square + 8, board_[All]) &&
+            is_set(target_square + 8, allowed))
         {
           // two square push
           addMove(moves, source_square, target_square + 8, WhitePawn, NoPiece, 0,1,0,0);
@@ -451,30 +486,34 @@ void MoveGenerator::generateWhitePawnMoves(const Board& board_,
       }
     }
 
-    auto attacks = pawn_attacks[White][source_square] & board_[BlackAll];
+    auto attacks = tables::pawn_attacks[White][source_square] & board_[BlackAll] &
+                   masks.targets & allowed;
 
     while (attacks) {
       target_square = bits::get_lsb_index(attacks);
+      Piece captured = capturedPiece<White>(board_, target_square);
 
       // capturing promotion
       if (source_square >= chess::A7 && source_square <= chess::H7) {
-        addMove(moves, source_square, target_square, WhitePawn, WhiteQueen, 1,0,0,0);
-        addMove(moves, source_square, target_square, WhitePawn, WhiteRook,  1,0,0,0);
-        addMove(moves, source_square, target_square, WhitePawn, WhiteBishop,1,0,0,0);
-        addMove(moves, source_square, target_square, WhitePawn, WhiteKnight,1,0,0,0);
+        addMove(moves, source_square, target_square, WhitePawn, WhiteQueen, captured,0,0,0);
+        addMove(moves, source_square, target_square, WhitePawn, WhiteRook,  captured,0,0,0);
+        addMove(moves, source_square, target_square, WhitePawn, WhiteBishop,captured,0,0,0);
+        addMove(moves, source_square, target_square, WhitePawn, WhiteKnight,captured,0,0,0);
 
       } else { // capture, no promotion
-          addMove(moves, source_square, target_square, WhitePawn, NoPiece, 1,0,0,0);
+          addMove(moves, source_square, target_square, WhitePawn, NoPiece, captured,0,0,0);
       }
 
       clear_bit(target_square, attacks);
     }
 
-    if (state.en_passant_target != chess::NoSquare) {
-      auto en_passant_attacks = pawn_attacks[White][source_square] & (1ULL << state.en_passant_target);
-      if (en_passant_attacks) {
+    if (masks.captures && state.en_passant_target != chess::NoSquare) {
+      auto en_passant_attacks = tables::pawn_attacks[White][source_square] & (1ULL << state.en_passant_target);
+      if (en_passant_attacks &&
+          isLegalEnPassant<White>(board_, source_square, state.en_passant_target, masks.king))
+      {
         auto attack_square = bits::get_lsb_index(en_passant_attacks);
-          addMove(moves, source_square, attack_square, WhitePawn, NoPiece, 1,0,1,0);
+          addMove(moves, source_square, attack_square, WhitePawn, NoPiece, BlackPawn,0,1,0);
       }
     }
 
@@ -489,7 +528,8 @@ void MoveGenerator::generateWhitePawnMoves(const Board& board_,
  *******************************************************************************/
 void MoveGenerator::generateBlackPawnMoves(const Board& board_,
                                            const BoardState& state,
-                                           std::vector<HashedMove>& moves) const
+                                           const MoveMasks& masks,
+                                           MoveList& moves) const
 {
   Bitboard board = board_[BlackPawn];
   uint8_t source_square = 0;
@@ -497,6 +537,8 @@ void MoveGenerator::generateBlackPawnMoves(const Board& board_,
 
   while (board) {
     source_square = bits::get_lsb_index(board);
+    const Bitboard allowed = allowedTargets(source_square, masks);
+
     // this is a black pawn push of 1 square
     target_square = source_square - 8;
 
@@ -505,16 +547,21 @@ void MoveGenerator::generateBlackPawnMoves(const Board& board_,
       // promotion
       if (source_square >= chess::A2 && source_square <= chess::H2)
       {
-        addMove(moves, source_square, target_square, BlackPawn, BlackQueen, 0,0,0,0);
-        addMove(moves, source_square, target_square, BlackPawn, BlackRook,  0,0,0,0);
-        addMove(moves, source_square, target_square, BlackPawn, BlackBishop,0,0,0,0);
-        addMove(moves, source_square, target_square, BlackPawn, BlackKnight,0,0,0,0);
+        if (masks.captures && is_set(target_square, allowed)) {
+          addMove(moves, source_square, target_square, BlackPawn, BlackQueen, 0,0,0,0);
+          addMove(moves, source_square, target_square, BlackPawn, BlackRook,  0,0,0,0);
+          addMove(moves, source_square, target_square, BlackPawn, BlackBishop,0,0,0,0);
+          addMove(moves, source_square, target_square, BlackPawn, BlackKnight,0,0,0,0);
+        }
 
-      } else { // one move forward, no promotion
-        addMove(moves, source_square, target_square, BlackPawn, NoPiece, 0,0,0,0);
+      } else if (masks.quiets) { // one move forward, no promotion
+        if (is_set(target_square, allowed)) {
+          addMove(moves, source_square, target_square, BlackPawn, NoPiece, 0,0,0,0);
+        }
 
         if (source_square >= chess::A7 && source_square <= chess::H7 &&
-            !is_set(target_square - 8, board_[All]))
+            !is_set(target_square - 8, board_[All]) &&
+            is_set(target_square - 8, allowed))
         {
           // two square push
           addMove(moves, source_square, target_square - 8, BlackPawn, NoPiece, 0,1,0,0);
@@ -522,28 +569,32 @@ void MoveGenerator::generateBlackPawnMoves(const Board& board_,
       }
     }
 
-    auto attacks = pawn_attacks[Black][source_square] & board_[WhiteAll];
+    auto attacks = tables::pawn_attacks[Black][source_square] & board_[WhiteAll] &
+                   masks.targets & allowed;
 
     while (attacks) {
       target_square = bits::get_lsb_index(attacks);
+      Piece captured = capturedPiece<Black>(board_, target_square);
 
       // promotion
       if (source_square >= chess::A2 && source_square <= chess::H2) {
-        addMove(moves, source_square, target_square, BlackPawn, BlackQueen, 1,0,0,0);
-        addMove(moves, source_square, target_square, BlackPawn, BlackRook,  1,0,0,0);
-        addMove(moves, source_square, target_square, BlackPawn, BlackBishop,1,0,0,0);
-        addMove(moves, source_square, target_square, BlackPawn, BlackKnight,1,0,0,0);
+        addMove(moves, source_square, target_square, BlackPawn, BlackQueen, captured,0,0,0);
+        addMove(moves, source_square, target_square, BlackPawn, BlackRook,  captured,0,0,0);
+        addMove(moves, source_square, target_square, BlackPawn, BlackBishop,captured,0,0,0);
+        addMove(moves, source_square, target_square, BlackPawn, BlackKnight,captured,0,0,0);
       } else { // capture, no promotion
-        addMove(moves, source_square, target_square, BlackPawn, NoPiece, 1,0,0,0);
+        addMove(moves, source_square, target_square, BlackPawn, NoPiece, captured,0,0,0);
       }
       clear_bit(target_square, attacks);
     }
 
-    if (state.en_passant_target != chess::NoSquare) {
-      auto en_passant_attacks = pawn_attacks[Black][source_square] & (1ULL << state.en_passant_target);
-      if (en_passant_attacks) {
+    if (masks.captures && state.en_passant_target != chess::NoSquare) {
+      auto en_passant_attacks = tables::pawn_attacks[Black][source_square] & (1ULL << state.en_passant_target);
+      if (en_passant_attacks &&
+          isLegalEnPassant<Black>(board_, source_square, state.en_passant_target, masks.king))
+      {
         auto attack_square = bits::get_lsb_index(en_passant_attacks);
-        addMove(moves, source_square, attack_square, BlackPawn, NoPiece, 1,0,1,0);
+        addMove(moves, source_square, attack_square, BlackPawn, NoPiece, WhitePawn,0,1,0);
       }
     }
     clear_bit(source_square, board);
@@ -558,18 +609,24 @@ void MoveGenerator::generateBlackPawnMoves(const Board& board_,
 template<Color c>
 void MoveGenerator::generateCastlingMoves(const Board& board_,
                                           const BoardState& state,
-                                          std::vector<HashedMove>& moves) const
+                                          const MoveMasks& masks,
+                                          MoveList& moves) const
 {
   using namespace util;
 
+  // can't castle out of check
+  if (masks.checkers) {
+    return;
+  }
+
   if constexpr (c == White) {
     if (state.castling_rights & toul(CastlingRights::WhiteKingSide))
     {
       if (!is_set(chess::F1, board_[All]) &&
           !is_set(chess::G1, board_[All]))
       {
-        if (!isSquareAttacked(chess::E1, Black, board_) &&
-            !isSquareAttacked(chess::F1, Black, board_))
+        if (!is_set(chess::F1, masks.danger) &&
+            !is_set(chess::G1, masks.danger))
         {
           addMove(moves, chess::E1, chess::G1, WhiteKing, NoPiece, 0,0,0,1);
         }
@@ -582,8 +639,8 @@ void MoveGenerator::generateCastlingMoves(const Board& board_,
           !(is_set(chess::C1, board_[All])) &&
           !(is_set(chess::B1, board_[All])))
       {
-        if (!isSquareAttacked(chess::E1, Black, board_) &&
-            !isSquareAttacked(chess::D1, Black, board_))
+        if (!is_set(chess::D1, masks.danger) &&
+            !is_set(chess::C1, masks.danger))
         {
           addMove(moves, chess::E1, chess::C1, WhiteKing, NoPiece, 0,0,0,1);
         }
@@ -597,8 +654,8 @@ void MoveGenerator::generateCastlingMoves(const Board& board_,
       if (!is_set(chess::F8, board_[All]) &&
           !is_set(chess::G8, board_[All]))
       {
-        if (!isSquareAttacked(chess::E8, White, board_) &&
-            !isSquareAttacked(chess::F8, White, board_))
+        if (!is_set(chess::F8, masks.danger) &&
+            !is_set(chess::G8, masks.danger))
         {
           addMove(moves, chess::E8, chess::G8, BlackKing, NoPiece, 0,0,0,1);
         }
@@ -611,8 +668,8 @@ void MoveGenerator::generateCastlingMoves(const Board& board_,
           !is_set(chess::C8, board_[All]) &&
           !is_set(chess::B8, board_[All]))
       {
-        if (!isSquareAttacked(chess::E8, White, board_) &&
-            !isSquareAttacked(chess::D8, White, board_))
+        if (!is_set(chess::D8, masks.danger) &&
+            !is_set(chess::C8, masks.danger))
         {
           addMove(moves, chess::E8, chess::C8, BlackKing, NoPiece, 0,0,0,1);
         }
@@ -629,11 +686,11 @@ void MoveGenerator::generateCastlingMoves(const Board& board_,
  *******************************************************************************/
 template<Color side>
 void MoveGenerator::generateKnightMoves(const Board& board_,
-                                        std::vector<HashedMove>& moves) const
+                                        const MoveMasks& masks,
+                                        MoveList& moves) const
 {
   constexpr Piece piece_t = (side == White) ? WhiteKnight : BlackKnight;
   constexpr Piece all_color = (side == White) ? WhiteAll : BlackAll;
-  constexpr Piece opp_color = (side == White) ? BlackAll : WhiteAll;
 
   Bitboard board = board_[piece_t];
   Bitboard attacks = 0ULL;
@@ -643,18 +700,18 @@ void MoveGenerator::generateKnightMoves(const Board& board_,
 
   while (board) {
     source_square = bits::get_lsb_index(board);
-    attacks = knight_attacks[source_square] & ~(board_[all_color]);
+    attacks = tables::knight_attacks[source_square] & ~(board_[all_color]) &
+              allowedTargets(source_square, masks) & masks.targets;
 
     while (attacks) {
       target_square = bits::get_lsb_index(attacks);
 
-      auto is_capture =
-          static_cast<bool>(is_set(target_square, board_[opp_color]));
+      Piece captured = capturedPiece<side>(board_, target_square);
 
       addMove(moves,
               source_square,
               target_square,
-              piece_t, NoPiece, is_capture, 0, 0, 0);
+              piece_t, NoPiece, captured, 0, 0, 0);
 
       clear_bit(target_square, attacks);
     }
@@ -670,11 +727,11 @@ void MoveGenerator::generateKnightMoves(const Board& board_,
  *******************************************************************************/
 template<Color side>
 void MoveGenerator::generateBishopMoves(const Board& board_,
-                                        std::vector<HashedMove>& moves) const
+                                        const MoveMasks& masks,
+                                        MoveList& moves) const
 {
   constexpr Piece piece_t = (side == White) ? WhiteBishop : BlackBishop;
   constexpr Piece all_color = (side == White) ? WhiteAll : BlackAll;
-  constexpr Piece opp_color = (side == White) ? BlackAll : WhiteAll;
 
   Bitboard board = board_[piece_t];
   Bitboard attacks = 0ULL;
@@ -684,18 +741,18 @@ void MoveGenerator::generateBishopMoves(const Board& board_,
 
   while (board) {
     source_square = bits::get_lsb_index(board);
-    attacks = getBishopAttacks(source_square, board_[All]) & ~(board_[all_color]);
+    attacks = getBishopAttacks(source_square, board_[All]) & ~(board_[all_color]) &
+              allowedTargets(source_square, masks) & masks.targets;
 
     while (attacks) {
       target_square = bits::get_lsb_index(attacks);
 
-      auto is_capture =
-          static_cast<bool>(is_set(target_square, board_[opp_color]));
+      Piece captured = capturedPiece<side>(board_, target_square);
 
       addMove(moves,
               source_square,
               target_square,
-              piece_t, NoPiece, is_capture, 0, 0, 0);
+              piece_t, NoPiece, captured, 0, 0, 0);
 
       clear_bit(target_square, attacks);
     }
@@ -711,11 +768,11 @@ void MoveGenerator::generateBishopMoves(const Board& board_,
  *******************************************************************************/
 template<Color side>
 void MoveGenerator::generateRookMoves(const Board& board_,
-                                      std::vector<HashedMove>& moves) const
+                                      const MoveMasks& masks,
+                                      MoveList& moves) const
 {
   constexpr Piece piece_t = (side == White) ? WhiteRook : BlackRook;
   constexpr Piece all_color = (side == White) ? WhiteAll : BlackAll;
-  constexpr Piece opp_color = (side == White) ? BlackAll : WhiteAll;
 
   Bitboard board = board_[piece_t];
   Bitboard attacks = 0ULL;
@@ -725,18 +782,18 @@ void MoveGenerator::generateRookMoves(const Board& board_,
 
   while (board) {
     source_square = bits::get_lsb_index(board);
-    attacks = getRookAttacks(source_square, board_[All]) & ~(board_[all_color]);
+    attacks = getRookAttacks(source_square, board_[All]) & ~(board_[all_color]) &
+              allowedTargets(source_square, masks) & masks.targets;
 
     while (attacks) {
       target_square = bits::get_lsb_index(attacks);
 
-      auto is_capture =
-          static_cast<bool>(is_set(target_square, board_[opp_color]));
+      Piece captured = capturedPiece<side>(board_, target_square);
 
       addMove(moves,
               source_square,
               target_square,
-              piece_t, NoPiece, is_capture, 0, 0, 0);
+              piece_t, NoPiece, captured, 0, 0, 0);
 
       clear_bit(target_square, attacks);
     }
@@ -752,11 +809,11 @@ void MoveGenerator::generateRookMoves(const Board& board_,
  *******************************************************************************/
 template<Color side>
 void MoveGenerator::generateQueenMoves(const Board& board_,
-                                       std::vector<HashedMove>& moves) const
+                                       const MoveMasks& masks,
+                                       MoveList& moves) const
 {
   constexpr Piece piece_t = (side == White) ? WhiteQueen : BlackQueen;
   constexpr Piece all_color = (side == White) ? WhiteAll : BlackAll;
-  constexpr Piece opp_color = (side == White) ? BlackAll : WhiteAll;
 
   Bitboard board = board_[piece_t];
   Bitboard attacks = 0ULL;
@@ -766,18 +823,18 @@ void MoveGenerator::generateQueenMoves(const Board& board_,
 
   while (board) {
     source_square = bits::get_lsb_index(board);
-    attacks = getQueenAttacks(source_square, board_[All]) & ~(board_[all_color]);
+    attacks = getQueenAttacks(source_square, board_[All]) & ~(board_[all_color]) &
+              allowedTargets(source_square, masks) & masks.targets;
 
     while (attacks) {
       target_square = bits::get_lsb_index(attacks);
 
-      auto is_capture =
-          static_cast<bool>(is_set(target_square, board_[opp_color]));
+      Piece captured = capturedPiece<side>(board_, target_square);
 
       addMove(moves,
               source_square,
               target_square,
-              piece_t, NoPiece, is_capture, 0, 0, 0);
+              piece_t, NoPiece, captured, 0, 0, 0);
 
       clear_bit(target_square, attacks);
     }
@@ -788,16 +845,16 @@ void MoveGenerator::generateQueenMoves(const Board& board_,
 
 /*******************************************************************************
  *
- * Method: generateKingMoves(const Board&, std::vector& moves)
+ * Method: generateKingMoves(const Board&, const MoveMasks&, MoveList& moves)
  *
  *******************************************************************************/
 template<Color side>
 void MoveGenerator::generateKingMoves(const Board& board_,
-                                      std::vector<HashedMove>& moves) const
+                                      const MoveMasks& masks,
+                                      MoveList& moves) const
 {
   constexpr Piece piece_t = (side == White) ? WhiteKing : BlackKing;
   constexpr Piece all_color = (side == White) ? WhiteAll : BlackAll;
-  constexpr Piece opp_color = (side == White ) ? BlackAll : WhiteAll;
 
   Bitboard board = board_[piece_t];
   Bitboard attacks = 0ULL;
@@ -807,18 +864,18 @@ void MoveGenerator::generateKingMoves(const Board& board_,
 
   while (board) {
     source_square = bits::get_lsb_index(board);
-    attacks = king_attacks[source_square] & ~(board_[all_color]);
+    attacks = tables::king_attacks[source_square] & ~(board_[all_color]) &
+              ~masks.danger & masks.targets;
 
     while (attacks) {
       target_square = bits::get_lsb_index(attacks);
 
-      auto is_capture =
-          static_cast<bool>(is_set(target_square, board_[opp_color]));
+      Piece captured = capturedPiece<side>(board_, target_square);
 
       addMove(moves,
               source_square,
               target_square,
-              piece_t, NoPiece, is_capture, 0, 0, 0);
+              piece_t, NoPiece, captured, 0, 0, 0);
 
       clear_bit(target_square, attacks);
     }
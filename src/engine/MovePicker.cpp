@@ -0,0 +1,234 @@
+#include "engine/MovePicker.hxx"
+
+#include <utility>
+
+namespace chess {
+
+/*******************************************************************************
+ *
+ * Method: MovePicker(const BoardManager&, PackedMove, const Killers&,
+ *                    const HistoryTable&)
+ *
+ *******************************************************************************/
+MovePicker::MovePicker(const BoardManager& board,
+                       PackedMove tt_move,
+                       const Killers& killers,
+                       const HistoryTable& history)
+  : _board(board)
+  , _history(&history)
+  , _tt_move(tt_move)
+  , _killers(killers)
+  , _stage(Stage::TTMove)
+{
+}
+
+/*******************************************************************************
+ *
+ * Method: MovePicker(const BoardManager&)
+ *
+ *******************************************************************************/
+MovePicker::MovePicker(const BoardManager& board)
+  : _board(board)
+  , _stage(Stage::GenerateCaptures)
+  , _captures_only(true)
+{
+}
+
+/*******************************************************************************
+ *
+ * Method: next()
+ *
+ *******************************************************************************/
+std::optional<HashedMove> MovePicker::next()
+{
+  switch (_stage) {
+    case Stage::TTMove:
+      _stage = Stage::GenerateCaptures;
+
+      // the move is only trusted once it is found among the legal moves,
+      // it may come from a different position with the same key
+      if (!_tt_move.empty()) {
+        const bool tactical = _tt_move.kind() == PackedMove::Promotion ||
+                              _tt_move.kind() == PackedMove::EnPassant ||
+                              _board.pieceOn(_tt_move.target()) != NoPiece;
+
+        if (tactical) {
+          generateCaptures();
+        } else {
+          generateQuiets();
+        }
+
+        for (const auto& move : tactical ? _captures : _quiets) {
+          if (PackedMove(move) == _tt_move) {
+            return move;
+          }
+        }
+      }
+      [[fallthrough]];
+
+    case Stage::GenerateCaptures:
+      generateCaptures();
+      _index = 0;
+      _stage = Stage::GoodCaptures;
+      [[fallthrough]];
+
+    case Stage::GoodCaptures:
+      while (_index < _captures.size()) {
+        auto move = pickBest(_captures, _capture_scores);
+
+        if (PackedMove(move) == _tt_move) {
+          continue;
+        }
+
+        // taking a piece worth at least the attacker can't lose material,
+        // only the others need the exchange played out
+        if (eval::piece_values[move.m.piece] > eval::piece_values[move.m.captured] &&
+            _board.see(move) < 0)
+        {
+          if (!_captures_only) {
+            _bad_captures.push_back(move);
+          }
+          continue;
+        }
+
+        return move;
+      }
+
+      if (_captures_only) {
+        _stage = Stage::Done;
+        return std::nullopt;
+      }
+
+      generateQuiets();
+      _stage = Stage::Killers;
+      [[fallthrough]];
+
+    case Stage::Killers:
+      while (_killer_index < _killers.size()) {
+        const auto killer = _killers[_killer_index++];
+
+        if (killer.empty() || killer == _tt_move) {
+          continue;
+        }
+
+        // a killer from a sibling may not be legal here, or may have
+        // become a capture that was already handed out
+        for (const auto& move : _quiets) {
+          if (PackedMove(move) == killer) {
+            return move;
+          }
+        }
+      }
+
+      _index = 0;
+      _stage = Stage::Quiets;
+      [[fallthrough]];
+
+    case Stage::Quiets:
+      while (_index < _quiets.size()) {
+        auto move = pickBest(_quiets, _quiet_scores);
+
+        if (!isSpecial(move)) {
+          return move;
+        }
+      }
+
+      _index = 0;
+      _stage = Stage::BadCaptures;
+      [[fallthrough]];
+
+    case Stage::BadCaptures:
+      if (_index < _bad_captures.size()) {
+        return _bad_captures[_index++];
+      }
+
+      _stage = Stage::Done;
+      [[fallthrough]];
+
+    case Stage::Done:
+      break;
+  }
+
+  return std::nullopt;
+}
+
+/*******************************************************************************
+ *
+ * Method: generateCaptures()
+ *
+ *******************************************************************************/
+void MovePicker::generateCaptures()
+{
+  if (_captures_generated) {
+    return;
+  }
+  _captures_generated = true;
+
+  _board.generateCaptures(_captures);
+
+  // most valuable victim first, then least valuable attacker.
+  // promotions count the piece they gain
+  for (auto i : util::range(_captures.size())) {
+    const auto& m = _captures[i].m;
+    _capture_scores[i] = eval::piece_values[m.captured] * 8 -
+                         eval::piece_values[m.piece] / 100 +
+                         eval::piece_values[m.promoted];
+  }
+}
+
+/*******************************************************************************
+ *
+ * Method: generateQuiets()
+ *
+ *******************************************************************************/
+void MovePicker::generateQuiets()
+{
+  if (_quiets_generated) {
+    return;
+  }
+  _quiets_generated = true;
+
+  _board.generateQuiets(_quiets);
+
+  const Color side = _board.getSideToMove();
+
+  for (auto i : util::range(_quiets.size())) {
+    const auto& m = _quiets[i].m;
+    _quiet_scores[i] = (*_history)[side][m.source][m.target];
+  }
+}
+
+/*******************************************************************************
+ *
+ * Method: isSpecial(const HashedMove&)
+ *
+ *******************************************************************************/
+bool MovePicker::isSpecial(const HashedMove& move) const
+{
+  const PackedMove packed(move);
+  return packed == _tt_move || packed == _killers[0] || packed == _killers[1];
+}
+
+/*******************************************************************************
+ *
+ * Method: pickBest(MoveList&, std::array<int, MoveList::Capacity>&)
+ *
+ *******************************************************************************/
+HashedMove MovePicker::pickBest(MoveList& moves,
+                                std::array<int, MoveList::Capacity>& scores)
+{
+  size_t best = _index;
+
+  for (size_t i = _index + 1; i < moves.size(); i++) {
+    if (scores[i] > scores[best]) {
+      best = i;
+    }
+  }
+
+  std::swap(moves[best], moves[_index]);
+  std::swap(scores[best], scores[_index]);
+
+  return moves[_index++];
+}
+
+} // namespace chess
@@ -0,0 +1,131 @@
+#include "engine/TranspositionTable.hxx"
+
+#include <algorithm>
+#include <bit>
+#include <limits>
+
+namespace chess {
+
+/*******************************************************************************
+ *
+ * Method: TranspositionTable(size_t size_mb)
+ *
+ *******************************************************************************/
+TranspositionTable::TranspositionTable(size_t size_mb)
+{
+  resize(size_mb);
+}
+
+/*******************************************************************************
+ *
+ * Method: resize(size_t size_mb)
+ *
+ *******************************************************************************/
+void TranspositionTable::resize(size_t size_mb)
+{
+  size_t count = std::max<size_t>(size_mb, 1) * 1024 * 1024 / sizeof(Bucket);
+  count = std::bit_floor(count);
+
+  // atomics can't be moved, so build a new table instead of resizing
+  _buckets = std::vector<Bucket>(count);
+  _mask = count - 1;
+  _generation = 0;
+}
+
+/*******************************************************************************
+ *
+ * Method: clear()
+ *
+ *******************************************************************************/
+void TranspositionTable::clear()
+{
+  for (auto& bucket : _buckets) {
+    for (auto& slot : bucket.slots) {
+      slot.key_xor_data.store(0, std::memory_order_relaxed);
+      slot.data.store(0, std::memory_order_relaxed);
+    }
+  }
+  _generation = 0;
+}
+
+/*******************************************************************************
+ *
+ * Method: probe(zobrist::Key)
+ *
+ *******************************************************************************/
+std::optional<TranspositionTable::Entry>
+TranspositionTable::probe(zobrist::Key key) const
+{
+  const auto& bucket = _buckets[key & _mask];
+
+  for (const auto& slot : bucket.slots) {
+    Data d;
+    d.raw = slot.data.load(std::memory_order_relaxed);
+
+    if ((slot.key_xor_data.load(std::memory_order_relaxed) ^ d.raw) != key ||
+        d.f.bound == util::toul(Bound::None))
+    {
+      continue;
+    }
+
+    return Entry{ PackedMove::fromRaw(d.f.move), static_cast<int>(d.f.score),
+                  static_cast<int>(d.f.depth), static_cast<Bound>(d.f.bound) };
+  }
+
+  return std::nullopt;
+}
+
+/*******************************************************************************
+ *
+ * Method: store(zobrist::Key, PackedMove, int score, int depth, Bound)
+ *
+ *******************************************************************************/
+void TranspositionTable::store(zobrist::Key key, PackedMove move,
+                               int score, int depth, Bound bound)
+{
+  auto& bucket = _buckets[key & _mask];
+
+  Slot* replace = nullptr;
+  Data old;
+  int worst = std::numeric_limits<int>::max();
+
+  for (auto& slot : bucket.slots) {
+    Data d;
+    d.raw = slot.data.load(std::memory_order_relaxed);
+
+    // same position, always overwrite
+    if ((slot.key_xor_data.load(std::memory_order_relaxed) ^ d.raw) == key) {
+      replace = &slot;
+      old = d;
+      break;
+    }
+
+    // otherwise prefer empty, then stale, then shallow entries
+    int age = (_generation - d.f.generation) & GenerationMask;
+    int value = d.f.bound == util::toul(Bound::None) ? -1'000
+                                                      : d.f.depth - 8 * age;
+    if (value < worst) {
+      worst = value;
+      replace = &slot;
+      old.raw = 0;
+    }
+  }
+
+  // keep the old move if this search did not produce one
+  if (move.empty()) {
+    move = PackedMove::fromRaw(old.f.move);
+  }
+
+  Data d;
+  d.raw = 0;
+  d.f.move = move.raw();
+  d.f.score = std::clamp(score, -MaxScore, MaxScore);
+  d.f.depth = std::clamp(depth, 0, 255);
+  d.f.bound = util::toul(bound);
+  d.f.generation = _generation;
+
+  replace->key_xor_data.store(key ^ d.raw, std::memory_order_relaxed);
+  replace->data.store(d.raw, std::memory_order_relaxed);
+}
+
+} // namespace chess
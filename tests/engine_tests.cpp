@@ -0,0 +1,297 @@
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "engine/AI.hxx"
+#include "engine/BoardManager.hxx"
+#include "engine/Log.hxx"
+#include "engine/MoveGenerator.hxx"
+
+namespace {
+
+struct SeePosition {
+  const char* fen;
+
+  // in coordinate notation, e.g. e4d5
+  const char* move;
+
+  // with pawn 100, knight 300, bishop 325, rook 500, queen 900
+  int expected;
+};
+
+// exchanges worked out by hand
+const std::vector<SeePosition> see_suite = {
+  // undefended pawn
+  { "1k1r4/1pp4p/p7/4p3/8/P5P1/1PP4P/2K1R3 w - - 0 1", "e1e5", 100 },
+
+  // knight for pawn after the whole pile on e5 is traded
+  { "1k1r3q/1ppn3p/p4b2/4p3/8/P2N2P1/1PP1R1BP/2K1Q3 w - - 0 1", "d3e5", -200 },
+
+  // pawn for pawn
+  { "4k3/8/2p5/3p4/4P3/8/8/4K3 w - - 0 1", "e4d5", 0 },
+
+  // queen for a defended pawn
+  { "4k3/8/2p5/3p4/8/8/3Q4/4K3 w - - 0 1", "d2d5", -800 },
+
+  // the rook behind backs up the first through the x-ray
+  { "3rk3/8/8/3p4/8/8/3R4/3RK3 w - - 0 1", "d2d5", 100 },
+
+  // the king can't recapture, the second rook guards d5
+  { "8/8/3k4/3p4/8/8/3R4/3RK3 w - - 0 1", "d2d5", 100 },
+
+  // it can when nothing guards the square
+  { "8/8/3k4/3p4/8/8/8/3RK3 w - - 0 1", "d1d5", -400 },
+
+  // en passant
+  { "4k3/8/8/3pP3/8/8/8/4K3 w - d6 0 1", "e5d6", 100 },
+
+  // promoting where the new queen is taken
+  { "r3k3/1P6/8/8/8/8/8/4K3 w - - 0 1", "b7b8q", -100 },
+
+  // promoting safely
+  { "4k3/1P6/8/8/8/8/8/4K3 w - - 0 1", "b7b8q", 800 },
+
+  // black to move, bishop takes a knight defended by a pawn
+  { "4k3/8/4b3/8/2N5/1P6/8/4K3 b - - 0 1", "e6c4", -25 },
+
+  // quiet move onto an attacked square
+  { "4k3/8/8/8/8/2p5/8/3NK3 w - - 0 1", "d1b2", -300 },
+};
+
+struct DrawPosition {
+  const char* name;
+  const char* fen;
+
+  // fixed depth of the search
+  int depth;
+
+  // what the search should report, a mate in moves or else a score
+  int mate;
+  int score;
+};
+
+// searches that have to see a draw coming, or see through one
+const std::vector<DrawPosition> draw_suite = {
+  // checks on the hundredth half move with a way out are still draws,
+  // even when the only way out resets the clock. Ng6+ hxg6 Rh1# is
+  // otherwise a mate in two
+  { "check at clock 100", "7k/6pp/8/4N3/2B5/8/8/K3R3 w - - 99 80", 4, 0, 0 },
+
+  // a mate on the hundredth half move stands
+  { "mate at clock 100", "6k1/5ppp/8/8/8/8/8/R5K1 w - - 99 80", 3, 1, 0 },
+
+  // a queen against two rooks is lost, but Qe8+ Kh7 Qh5+ Kg8 comes
+  // back to the root
+  { "perpetual check", "6k1/6p1/8/7Q/8/rr6/8/6K1 w - - 0 1", 6, 0, 0 },
+};
+
+struct DrawLine {
+  const char* name;
+  const char* fen;
+
+  // moves in coordinate notation, only the last one may end the game
+  std::vector<const char*> moves;
+};
+
+// games the board has to call drawn on the last move
+const std::vector<DrawLine> draw_lines = {
+  // the start position comes back a third time
+  { "threefold repetition",
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    { "g1f3", "g8f6", "f3g1", "f6g8", "g1f3", "g8f6", "f3g1", "f6g8" } },
+
+  // the repeated position doesn't have to be the first one
+  { "threefold after moves",
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    { "g1f3", "g8f6", "b1c3", "b8c6", "c3b1", "c6b8", "b1c3", "b8c6",
+      "c3b1", "c6b8" } },
+
+  // the hundredth half move without a capture or pawn move
+  { "fifty move rule", "4k3/8/8/8/8/8/8/R3K3 w - - 98 80",
+    { "a1a2", "e8d8" } },
+};
+
+/*******************************************************************************
+ *
+ * Function: find_move(const BoardManager&, const char* move)
+ *
+ *******************************************************************************/
+// the legal move in coordinate notation, nothing if there is none
+std::optional<chess::HashedMove> find_move(const chess::BoardManager& board,
+                                           const char* move)
+{
+  chess::MoveList moves;
+  board.generateMoves(moves);
+
+  auto it = std::ranges::find_if(moves, [&](const auto& m) {
+    return chess::to_uci_string(m) == move;
+  });
+
+  if (it == moves.end()) {
+    return std::nullopt;
+  }
+
+  return *it;
+}
+
+/*******************************************************************************
+ *
+ * Function: test_see(const MoveGenerator&)
+ *
+ *******************************************************************************/
+bool test_see(const chess::MoveGenerator& generator)
+{
+  bool passed = true;
+
+  for (const auto& pos : see_suite) {
+    chess::BoardManager board(&generator, pos.fen);
+
+    auto move = find_move(board, pos.move);
+
+    if (!move) {
+      std::cout << "FAIL  " << pos.move << " is not legal in " << pos.fen << "\n";
+      passed = false;
+      continue;
+    }
+
+    int value = board.see(*move);
+    bool ok = value == pos.expected;
+
+    std::cout << (ok ? "ok    " : "FAIL  ") << pos.move << ": " << value;
+
+    if (!ok) {
+      std::cout << " expected " << pos.expected;
+    }
+
+    std::cout << "  " << pos.fen << "\n";
+
+    passed &= ok;
+  }
+
+  return passed;
+}
+
+/*******************************************************************************
+ *
+ * Function: test_draws(const MoveGenerator&)
+ *
+ *******************************************************************************/
+bool test_draws(const chess::MoveGenerator& generator)
+{
+  bool passed = true;
+
+  chess::log::set_sink({});
+
+  for (const auto& pos : draw_suite) {
+    chess::BoardManager board(&generator, pos.fen);
+
+    chess::AI ai(&generator, { chess::AIDifficulty::Hard, board.getSideToMove(), false, true });
+    ai.setThreads(1);
+
+    chess::SearchLimits limits;
+    limits.depth = pos.depth;
+
+    auto result = ai.getBestMove(board, limits);
+    bool ok = result.mate == pos.mate && (pos.mate || result.score == pos.score);
+
+    std::cout << (ok ? "ok    " : "FAIL  ") << pos.name << ": "
+              << (result.mate ? "mate " + std::to_string(result.mate)
+                              : std::to_string(result.score));
+
+    if (!ok) {
+      std::cout << " expected "
+                << (pos.mate ? "mate " + std::to_string(pos.mate)
+                             : std::to_string(pos.score));
+    }
+
+    std::cout << "\n";
+
+    passed &= ok;
+  }
+
+  for (const auto& line : draw_lines) {
+    chess::BoardManager board(&generator, line.fen);
+
+    bool ok = true;
+
+    for (size_t i = 0; ok && i < line.moves.size(); i++) {
+      auto move = find_move(board, line.moves[i]);
+
+      if (!move) {
+        std::cout << "FAIL  " << line.name << ": " << line.moves[i] << " is not legal\n";
+        ok = false;
+        break;
+      }
+
+      const auto expected = i + 1 == line.moves.size() ? chess::MoveResult::Draw
+                                                       : chess::MoveResult::Valid;
+
+      auto [result, made] = board.tryMove({ static_cast<uint8_t>(move->m.source),
+                                            static_cast<uint8_t>(move->m.target),
+                                            static_cast<chess::Piece>(move->m.promoted) });
+
+      if (result != expected) {
+        std::cout << "FAIL  " << line.name << ": " << line.moves[i] << " gave "
+                  << static_cast<int>(result) << " expected "
+                  << static_cast<int>(expected) << "\n";
+        ok = false;
+      }
+    }
+
+    if (ok) {
+      std::cout << "ok    " << line.name << "\n";
+    }
+
+    passed &= ok;
+  }
+
+  return passed;
+}
+
+struct TestGroup {
+  const char* name;
+  bool (*run)(const chess::MoveGenerator&);
+};
+
+const std::vector<TestGroup> groups = {
+  { "see", test_see },
+  { "draws", test_draws },
+};
+
+} // namespace
+
+// runs the named test groups, or all of them when none are named
+int main(int argc, char* argv[])
+{
+  for (int i = 1; i < argc; i++) {
+    const bool known = std::ranges::any_of(groups, [&](const auto& group) {
+      return std::strcmp(argv[i], group.name) == 0;
+    });
+
+    if (!known) {
+      std::cout << "unknown test group " << argv[i] << "\n";
+      return 1;
+    }
+  }
+
+  chess::MoveGenerator generator;
+
+  bool passed = true;
+
+  for (const auto& group : groups) {
+    const bool selected = argc < 2 ||
+      std::any_of(argv + 1, argv + argc, [&](const char* name) {
+        return std::strcmp(name, group.name) == 0;
+      });
+
+    if (selected) {
+      std::cout << "# " << group.name << "\n";
+      passed &= group.run(generator);
+    }
+  }
+
+  return passed ? 0 : 1;
+}
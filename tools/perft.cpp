@@ -0,0 +1,220 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "engine/BoardManager.hxx"
+#include "engine/MoveGenerator.hxx"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct ReferencePosition {
+  const char* name;
+  const char* fen;
+
+  // default depth when running the suite
+  int depth;
+
+  // expected node counts starting at depth 1
+  std::vector<uint64_t> nodes;
+};
+
+// https://www.chessprogramming.org/Perft_Results
+const std::vector<ReferencePosition> suite = {
+  { "start",
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 5,
+    { 20, 400, 8'902, 197'281, 4'865'609, 119'060'324 } },
+
+  { "kiwipete",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 4,
+    { 48, 2'039, 97'862, 4'085'603, 193'690'690 } },
+
+  { "position 3",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 5,
+    { 14, 191, 2'812, 43'238, 674'624, 11'030'083 } },
+
+  { "position 4",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 4,
+    { 6, 264, 9'467, 422'333, 15'833'292 } },
+
+  { "position 5",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 4,
+    { 44, 1'486, 62'379, 2'103'487, 89'941'194 } },
+
+  { "position 6",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 4,
+    { 46, 2'079, 89'890, 3'894'594, 164'075'551 } }
+};
+
+double seconds_since(Clock::time_point start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+uint64_t nodes_per_second(uint64_t nodes, double seconds) {
+  return seconds > 0.0 ? static_cast<uint64_t>(nodes / seconds) : 0;
+}
+
+/*******************************************************************************
+ *
+ * Function: perft(BoardManager&, int depth)
+ *
+ *******************************************************************************/
+uint64_t perft(chess::BoardManager& board, int depth)
+{
+  if (depth == 0) {
+    return 1;
+  }
+
+  chess::MoveList moves;
+  board.generateMoves(moves);
+
+  // the moves are legal, no need to play the last ply
+  if (depth == 1) {
+    return moves.size();
+  }
+
+  uint64_t nodes = 0;
+
+  for (const auto& move : moves) {
+    board.makeMove(move);
+    nodes += perft(board, depth - 1);
+    board.unmakeMove();
+  }
+
+  return nodes;
+}
+
+/*******************************************************************************
+ *
+ * Function: divide(const MoveGenerator&, const std::string& fen, int depth)
+ * prints the node count below each root move
+ *******************************************************************************/
+int divide(const chess::MoveGenerator& generator, const std::string& fen, int depth)
+{
+  chess::BoardManager board(&generator, fen);
+
+  chess::MoveList moves;
+  board.generateMoves(moves);
+
+  uint64_t total = 0;
+  auto start = Clock::now();
+
+  for (const auto& move : moves) {
+    board.makeMove(move);
+    uint64_t nodes = perft(board, depth - 1);
+    board.unmakeMove();
+
+    std::cout << chess::to_uci_string(move) << ": " << nodes << "\n";
+    total += nodes;
+  }
+
+  double elapsed = seconds_since(start);
+
+  std::cout << "\nnodes: " << total
+            << "\ntime:  " << elapsed << "s"
+            << "\nnps:   " << nodes_per_second(total, elapsed)
+            << "\nsliders: " << chess::tables::backend << "\n";
+
+  return 0;
+}
+
+/*******************************************************************************
+ *
+ * Function: run_suite(const MoveGenerator&, int depth)
+ * a depth below 1 uses the default depth of each position
+ *******************************************************************************/
+int run_suite(const chess::MoveGenerator& generator, int depth)
+{
+  uint64_t total = 0;
+  double total_time = 0.0;
+  bool passed = true;
+
+  for (const auto& pos : suite) {
+    int d = depth > 0 ? std::min<int>(depth, pos.nodes.size()) : pos.depth;
+
+    chess::BoardManager board(&generator, pos.fen);
+
+    auto start = Clock::now();
+    uint64_t nodes = perft(board, d);
+    double elapsed = seconds_since(start);
+
+    uint64_t expected = pos.nodes[d - 1];
+    bool ok = nodes == expected;
+
+    std::cout << (ok ? "ok    " : "FAIL  ") << pos.name
+              << " depth " << d << ": " << nodes;
+
+    if (!ok) {
+      std::cout << " expected " << expected;
+    }
+
+    std::cout << " (" << nodes_per_second(nodes, elapsed) << " nps)\n";
+
+    passed &= ok;
+    total += nodes;
+    total_time += elapsed;
+  }
+
+  std::cout << "\nnodes: " << total
+            << "\ntime:  " << total_time << "s"
+            << "\nnps:   " << nodes_per_second(total, total_time)
+            << "\nsliders: " << chess::tables::backend << "\n";
+
+  return passed ? 0 : 1;
+}
+
+/*******************************************************************************
+ *
+ * Function: usage(const char* name)
+ *
+ *******************************************************************************/
+void usage(const char* name)
+{
+  std::cout << "usage: " << name << " <depth> [fen]\n"
+            << "       " << name << " --suite [depth]\n\n"
+            << "  <depth> [fen]    perft divide of the fen (default start position)\n"
+            << "  --suite [depth]  run the reference positions, optionally\n"
+            << "                   overriding the depth of every position\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  if (argc < 2) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  chess::MoveGenerator generator;
+
+  try {
+    if (std::strcmp(argv[1], "--suite") == 0) {
+      return run_suite(generator, argc > 2 ? std::stoi(argv[2]) : 0);
+    }
+
+    int depth = std::stoi(argv[1]);
+    if (depth < 1) {
+      usage(argv[0]);
+      return 1;
+    }
+
+    std::string fen = chess::starting_position;
+    if (argc > 2) {
+      fen = argv[2];
+      for (int i = 3; i < argc; i++) {
+        fen += std::string(" ") + argv[i];
+      }
+    }
+
+    return divide(generator, fen, depth);
+  }
+  catch (const std::exception&) {
+    usage(argv[0]);
+    return 1;
+  }
+}
@@ -0,0 +1,385 @@
+#include <algorithm>
+#include <cctype>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+
+#include "engine/AI.hxx"
+#include "engine/BoardManager.hxx"
+#include "engine/Log.hxx"
+#include "engine/MoveGenerator.hxx"
+
+namespace {
+
+// https://www.shredderchess.com/chess-features/uci-universal-chess-interface.html
+class UciEngine
+{
+public:
+  UciEngine()
+    : _board(&_generator)
+    , _ai(&_generator, { chess::AIDifficulty::Hard, chess::White, false, true })
+  {
+    chess::log::set_sink([this](const std::string& message) {
+      send("info string " + message);
+    });
+  }
+
+  ~UciEngine() {
+    chess::log::set_sink({});
+  }
+
+  // read commands from stdin until quit or end of input
+  void loop();
+
+private:
+  chess::MoveGenerator _generator;
+  chess::BoardManager _board;
+  chess::AI _ai;
+
+  // set by stop, an infinite search waits for it before reporting
+  bool _stop_requested = false;
+  std::mutex _stop_mutex;
+  std::condition_variable _stop_cv;
+
+  std::mutex _output_mutex;
+
+  // write a line to stdout, safe to call from the search thread
+  void send(const std::string& line);
+
+  // report a completed iteration
+  void sendInfo(const chess::SearchResult& result);
+
+  void handleUci();
+  void handleSetOption(std::istringstream& args);
+  void handlePosition(std::istringstream& args);
+  void handleGo(std::istringstream& args);
+
+  // stop the running search and wait for it to report
+  void stopSearch();
+
+  // apply a move in coordinate notation, e.g. e2e4 or e7e8q
+  bool applyMove(const std::string& move);
+};
+
+/*******************************************************************************
+ *
+ * Method: send(const std::string&)
+ *
+ *******************************************************************************/
+void UciEngine::send(const std::string& line)
+{
+  std::lock_guard lock(_output_mutex);
+  std::cout << line << std::endl;
+}
+
+/*******************************************************************************
+ *
+ * Method: sendInfo(const chess::SearchResult&)
+ *
+ *******************************************************************************/
+void UciEngine::sendInfo(const chess::SearchResult& result)
+{
+  std::string line = "info depth " + std::to_string(result.depth) +
+                     " seldepth " + std::to_string(result.seldepth);
+
+  if (result.mate) {
+    line += " score mate " + std::to_string(result.mate);
+  } else {
+    line += " score cp " + std::to_string(result.score);
+  }
+
+  const auto ms = std::max<int64_t>(result.time.count(), 1);
+
+  line += " nodes " + std::to_string(result.nodes) +
+          " nps " + std::to_string(result.nodes * 1000 / ms) +
+          " time " + std::to_string(result.time.count()) +
+          " pv";
+
+  for (const auto& move : result.pv) {
+    line += " " + chess::to_uci_string(move);
+  }
+
+  send(line);
+}
+
+/*******************************************************************************
+ *
+ * Method: loop()
+ *
+ *******************************************************************************/
+void UciEngine::loop()
+{
+  std::string line;
+
+  while (std::getline(std::cin, line)) {
+    std::istringstream args(line);
+    std::string command;
+    args >> command;
+
+    if (command == "uci") {
+      handleUci();
+    }
+    else if (command == "isready") {
+      send("readyok");
+    }
+    else if (command == "setoption") {
+      stopSearch();
+      handleSetOption(args);
+    }
+    else if (command == "ucinewgame") {
+      stopSearch();
+      _board.reset();
+      _ai.clearHash();
+    }
+    else if (command == "position") {
+      stopSearch();
+      handlePosition(args);
+    }
+    else if (command == "go") {
+      stopSearch();
+      handleGo(args);
+    }
+    else if (command == "stop") {
+      stopSearch();
+    }
+    else if (command == "quit") {
+      break;
+    }
+  }
+
+  stopSearch();
+}
+
+/*******************************************************************************
+ *
+ * Method: handleUci()
+ *
+ *******************************************************************************/
+void UciEngine::handleUci()
+{
+  send("id name sukless2");
+  send("id author DrSegMcFault");
+  send("option name Threads type spin default 4 min 1 max 256");
+  send("option name Hash type spin default " +
+       std::to_string(chess::TranspositionTable::DefaultSizeMB) + " min 1 max 65536");
+  send("option name NullMove type check default true");
+  send("option name LateMoveReductions type check default true");
+  send("option name Futility type check default true");
+  send("uciok");
+}
+
+/*******************************************************************************
+ *
+ * Method: handleSetOption(std::istringstream&)
+ * setoption name <id> [value <x>]
+ *******************************************************************************/
+void UciEngine::handleSetOption(std::istringstream& args)
+{
+  std::string token;
+  std::string name;
+  std::string value;
+
+  args >> token;
+  if (token != "name") {
+    return;
+  }
+
+  while (args >> token && token != "value") {
+    name += name.empty() ? token : " " + token;
+  }
+
+  args >> value;
+
+  try {
+    if (name == "Threads") {
+      _ai.setThreads(std::stoul(value));
+    }
+    else if (name == "Hash") {
+      _ai.setHashSize(std::stoul(value));
+    }
+    else if (name == "NullMove") {
+      _ai.cfg.search.null_move = value == "true";
+    }
+    else if (name == "LateMoveReductions") {
+      _ai.cfg.search.late_move_reductions = value == "true";
+    }
+    else if (name == "Futility") {
+      _ai.cfg.search.futility = value == "true";
+    }
+  }
+  catch (const std::exception&) {
+    send("info string invalid value for " + name);
+  }
+}
+
+/*******************************************************************************
+ *
+ * Method: handlePosition(std::istringstream&)
+ * position [startpos | fen <fen>] [moves <move> ...]
+ *******************************************************************************/
+void UciEngine::handlePosition(std::istringstream& args)
+{
+  std::string token;
+  args >> token;
+
+  if (token == "startpos") {
+    _board.reset();
+    args >> token;
+  }
+  else if (token == "fen") {
+    std::string fen;
+    while (args >> token && token != "moves") {
+      fen += fen.empty() ? token : " " + token;
+    }
+    _board.reset(fen);
+  }
+  else {
+    return;
+  }
+
+  if (token != "moves") {
+    return;
+  }
+
+  while (args >> token) {
+    if (!applyMove(token)) {
+      send("info string illegal move " + token);
+      return;
+    }
+  }
+}
+
+/*******************************************************************************
+ *
+ * Method: handleGo(std::istringstream&)
+ *
+ *******************************************************************************/
+void UciEngine::handleGo(std::istringstream& args)
+{
+  chess::SearchLimits limits;
+  std::string token;
+
+  try {
+    while (args >> token) {
+      if (token == "depth") {
+        args >> token;
+        limits.depth = std::stoi(token);
+      }
+      else if (token == "nodes") {
+        args >> token;
+        limits.nodes = std::stoull(token);
+      }
+      else if (token == "movetime") {
+        args >> token;
+        limits.move_time = std::stoll(token);
+      }
+      else if (token == "wtime") {
+        args >> token;
+        limits.time[chess::White] = std::stoll(token);
+      }
+      else if (token == "btime") {
+        args >> token;
+        limits.time[chess::Black] = std::stoll(token);
+      }
+      else if (token == "winc") {
+        args >> token;
+        limits.increment[chess::White] = std::stoll(token);
+      }
+      else if (token == "binc") {
+        args >> token;
+        limits.increment[chess::Black] = std::stoll(token);
+      }
+      else if (token == "movestogo") {
+        args >> token;
+        limits.moves_to_go = std::stoi(token);
+      }
+      else if (token == "infinite") {
+        limits.infinite = true;
+      }
+    }
+  }
+  catch (const std::exception&) {
+    send("info string invalid go command");
+    return;
+  }
+
+  _ai.cfg.controlling = _board.getSideToMove();
+  _stop_requested = false;
+
+  // runs on the engine's search thread so stdin stays responsive
+  _ai.startSearch(_board, limits,
+    [this, limits](const chess::SearchResult& result) {
+      if (limits.infinite) {
+        std::unique_lock lock(_stop_mutex);
+        _stop_cv.wait(lock, [this] { return _stop_requested; });
+      }
+
+      auto move = result.bestMove();
+      send("bestmove " + (move ? chess::to_uci_string(*move) : std::string("0000")));
+    },
+    [this](const chess::SearchResult& result) {
+      sendInfo(result);
+    });
+}
+
+/*******************************************************************************
+ *
+ * Method: stopSearch()
+ *
+ *******************************************************************************/
+void UciEngine::stopSearch()
+{
+  {
+    std::lock_guard lock(_stop_mutex);
+    _stop_requested = true;
+  }
+  _stop_cv.notify_all();
+
+  _ai.stop();
+  _ai.wait();
+}
+
+/*******************************************************************************
+ *
+ * Method: applyMove(const std::string&)
+ *
+ *******************************************************************************/
+bool UciEngine::applyMove(const std::string& move)
+{
+  if (move.size() < 4) {
+    return false;
+  }
+
+  auto from = chess::fen::algebraic_to_index(move.substr(0, 2));
+  auto to = chess::fen::algebraic_to_index(move.substr(2, 2));
+
+  if (!from || !to) {
+    return false;
+  }
+
+  chess::Piece promoted = chess::NoPiece;
+
+  if (move.size() > 4) {
+    // the case of the piece decides its color
+    char c = _board.getSideToMove() == chess::White ? std::toupper(move[4])
+                                                    : std::tolower(move[4]);
+    promoted = chess::fen::char_to_piece(c).value_or(chess::NoPiece);
+  }
+
+  auto [result, made] = _board.tryMove({ *from, *to, promoted });
+  return result != chess::MoveResult::Illegal;
+}
+
+} // namespace
+
+int main()
+{
+  std::ios::sync_with_stdio(false);
+
+  UciEngine engine;
+  engine.loop();
+
+  return 0;
+}